@@ -0,0 +1,3 @@
+// Compiles the out of line definitions of sclap.h once, for the sclap library target.
+#define SCLAP_IMPLEMENTATION
+#include "sclap.h"
@@ -9,7 +9,56 @@
 #include <string>
 #include <cstring>
 #include <vector>
-#include <set>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <limits>
+#include <locale>
+#include <cmath>
+#include <system_error>
+#include <utility>
+
+#ifndef SCLAP_NO_THREADS
+#include <atomic>
+#include <thread>
+#endif
+
+// Define SCLAP_NO_SIMD to use only the scalar scans.
+#ifndef SCLAP_NO_SIMD
+#if defined(__AVX2__)
+#define SCLAP_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCLAP_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(SCLAP_NO_SIMD)
+#include <intrin.h>
+#endif
+
+// Header-only by default. With SCLAP_LIBRARY defined the header only declares the non-template
+// functions, and sclap.cpp (which defines SCLAP_IMPLEMENTATION) compiles them into the sclap library.
+#if defined(SCLAP_LIBRARY) && !defined(SCLAP_IMPLEMENTATION)
+#define SCLAP_DECLARATIONS_ONLY
+#endif
+
+#ifdef SCLAP_LIBRARY
+#define SCLAP_INLINE
+#else
+#define SCLAP_INLINE inline
+#endif
+
+// Define SCLAP_STATS to collect ParseStats in Options::parse, otherwise the
+// instrumentation is compiled out. With SCLAP_LIBRARY, define it for the library too.
+#ifdef SCLAP_STATS
+#include <atomic>
+#include <chrono>
+#define SCLAP_STAT(...) __VA_ARGS__
+#else
+#define SCLAP_STAT(...)
+#endif
 
 namespace sclap
 {
@@ -17,204 +66,313 @@ namespace sclap
 	/*------------------------------------------------------------------------------------------------*/
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-	const uint8_t UNEXISTED      = 0;
-	const uint8_t ARG_STRING     = 1 << 0;
-	const uint8_t ARG_BOOL       = 1 << 1;
-	const uint8_t ARG_INT        = 1 << 2;
-	const uint8_t ARG_REAL       = 1 << 3;
-	const uint8_t ARG_STRING_VEC = 1 << 4;
-	const uint8_t ARG_BOOL_VEC   = 1 << 5;
-	const uint8_t ARG_INT_VEC    = 1 << 6;
-	const uint8_t ARG_REAL_VEC   = 1 << 7;
+	// Type of the values of an option, one of the ARG_* constants.
+	typedef uint32_t ArgType;
+
+	const ArgType UNEXISTED      = 0;
+	const ArgType ARG_STRING     = 1 << 0;
+	const ArgType ARG_BOOL       = 1 << 1;
+	const ArgType ARG_INT        = 1 << 2;
+	const ArgType ARG_REAL       = 1 << 3;
+	const ArgType ARG_STRING_VEC = 1 << 4;
+	const ArgType ARG_BOOL_VEC   = 1 << 5;
+	const ArgType ARG_INT_VEC    = 1 << 6;
+	const ArgType ARG_REAL_VEC   = 1 << 7;
+	const ArgType ARG_INT64      = 1 << 8;
+	const ArgType ARG_UINT64     = 1 << 9;
+	// unsigned 64 bit with an optional binary suffix K, M or G (64K is 65536)
+	const ArgType ARG_SIZE       = 1 << 10;
+	// reals stored as float
+	const ArgType ARG_FLOAT_VEC  = 1 << 11;
 
 	const char OPT_SHORT_NONE = '\0';
+	const char LIST_DELIMITER_NONE = '\0';
 
+	// The ranges of one packed ARG_INT_VEC list (--ids=1-1000) hold at most this many
+	// values together, longer lists fail to read like invalid elements.
+	const size_t LIST_RANGE_MAX = 1 << 20;
+
+#ifdef SCLAP_STATS
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 	/*------------------------------------------------------------------------------------------------*/
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-	class OptionDescriptor
+	// Counters and times of one Options::parse (see SCLAP_STATS).
+	struct ParseStats
 	{
-	public:
-		OptionDescriptor(const char shortName, const char* longName,
-			uint8_t possibleArgumentValues)
-			: mShortName(shortName), mLongName(longName),
-			mPossibleArgumentValues(possibleArgumentValues)
-		{}
-
-		char shortName() const { return mShortName; }
-		const std::string& longName() const { return mLongName; }
-		uint8_t possibleArgumentValues() const { return mPossibleArgumentValues; }
-
-	private:
-		const char mShortName;
-		const std::string mLongName;
-		const uint8_t mPossibleArgumentValues;
+		// arguments consumed, after response files were expanded
+		size_t tokens;
+		// option arguments (--long, -abc), of them with more than one short option
+		size_t arguments;
+		size_t clusters;
+		// descriptor lookups by name, and hash slots compared by long name lookups
+		size_t lookups;
+		size_t probes;
+		// numeric conversions by type, ARG_SIZE with uint64 and float with real
+		// (PARSE_LAZY values convert on access, after the parse)
+		size_t intConversions;
+		size_t int64Conversions;
+		size_t uint64Conversions;
+		size_t realConversions;
+		// heap allocations of the parser (not the ones served by an Arena block)
+		size_t allocations;
+		size_t allocatedBytes;
+		// wall time in nanoseconds of resolving option names, of resolving the
+		// value type (getTypeToRead) and of reading and storing the values
+		uint64_t nameTime;
+		uint64_t typeTime;
+		uint64_t readTime;
 	};
 
-	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
-	/*------------------------------------------------------------------------------------------------*/
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-	class OptionDescriptors
+	// Receives the stats at the end of every Options::parse, on the parsing thread.
+	class ParseHook
 	{
 	public:
-		OptionDescriptors(const std::vector<OptionDescriptor>& descriptors);
-		OptionDescriptors() : mDescriptors(), mError(), mOk(true) {}
-		OptionDescriptors(const OptionDescriptors& optDesc)
-			: mDescriptors(optDesc.mDescriptors), mOk(optDesc.mOk), mError(optDesc.mError.str())
-		{ }
+		virtual ~ParseHook() {}
 
-		const OptionDescriptor* const operator[](const std::string& opt) const;
-		const OptionDescriptor* const operator[](char opt) const;
+		virtual void onParse(const ParseStats& stats) = 0;
+	};
 
-		bool valid() const { return mOk; }
-		std::string error() const { return mError.str(); }
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		OptionDescriptors& operator<<(const OptionDescriptor& OptionDescriptor)
+	namespace hidden
+	{
+		inline std::atomic<ParseHook*>& parseHook()
 		{
-			mDescriptors.push_back(OptionDescriptor);
-			check();
-			return *this;
+			static std::atomic<ParseHook*> hook(NULL);
+			return hook;
 		}
 
-	private:
-		std::vector<OptionDescriptor> mDescriptors;
+		// Stats of the parse running on this thread, NULL if there is none.
+		inline ParseStats*& currentStats()
+		{
+			static thread_local ParseStats* stats = NULL;
+			return stats;
+		}
 
-		std::stringstream mError;
-		bool mOk;
+		inline void addStat(size_t ParseStats::* counter, size_t n)
+		{
+			if (ParseStats* stats = currentStats()) stats->*counter += n;
+		}
 
-		void check();
-	};
+		inline uint64_t nanoseconds()
+		{
+			return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
 
-	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+		// Collects the stats of this thread into stats while in scope, then reports them.
+		class StatScope
+		{
+		public:
+			explicit StatScope(ParseStats& stats) : mStats(stats), mOuter(currentStats())
+			{
+				mStats = ParseStats();
+				currentStats() = &mStats;
+			}
 
-	OptionDescriptors::OptionDescriptors(const std::vector<OptionDescriptor>& descriptors)
-		: mDescriptors(descriptors), mError(), mOk(false)
-	{
-		check();
-	}
+			~StatScope()
+			{
+				currentStats() = mOuter;
+				if (ParseHook* hook = parseHook().load()) hook->onParse(mStats);
+			}
 
-	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+		private:
+			ParseStats& mStats;
+			ParseStats* const mOuter;
+		};
 
-	void OptionDescriptors::check()
-	{
-		std::vector<char> existingShortNames;
-		std::vector<std::string> existinglongNames;
-		for (size_t i = 0; i < mDescriptors.size(); ++i)
+		// Adds the time since the previous lap to a phase.
+		class PhaseClock
 		{
-			if (mDescriptors[i].longName().size() == 1)
-			{
-				mOk = false;
-				mError << "Long option length cant be 1: "
-					<< mDescriptors[i].longName()
-					<< ".\n";
-			}
-			for (size_t j = 0; j < existingShortNames.size(); ++j)
+		public:
+			PhaseClock() : mLast(nanoseconds()) {}
+
+			void lap(uint64_t ParseStats::* phase)
 			{
-				if (mDescriptors[i].shortName() == existingShortNames[j])
-				{
-					mOk = false;
-					mError << "Multiple option descriptors with the same short option: "
-						<< existingShortNames[j]
-						<< ".\n";
-				}
+				const uint64_t now = nanoseconds();
+				addTime(phase, now - mLast);
+				mLast = now;
 			}
-			for (size_t j = 0; j < existinglongNames.size(); ++j)
+
+		private:
+			uint64_t mLast;
+
+			static void addTime(uint64_t ParseStats::* phase, uint64_t time)
 			{
-				if (mDescriptors[i].longName() == existinglongNames[j])
-				{
-					mOk = false;
-					mError << "Multiple option descriptors with the same long option: "
-						<< existinglongNames[j]
-						<< ".\n";
-				}
+				if (ParseStats* stats = currentStats()) stats->*phase += time;
 			}
-		}
+		};
+	}
 
-		mOk = true;
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Process wide, NULL removes it. The hook is called from all parsing threads.
+	inline void setParseHook(ParseHook* hook)
+	{
+		hidden::parseHook().store(hook);
 	}
+#endif
 
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-	const OptionDescriptor* const OptionDescriptors::operator[](const std::string& opt) const
+	// Non owning reference to characters (std::string_view is not available in C++11).
+	class StringView
 	{
-		if (opt.empty()) { return NULL; }
+	public:
+		constexpr StringView() : mData(""), mSize(0) {}
+		constexpr StringView(const char* data, size_t size) : mData(data), mSize(size) {}
+		StringView(const char* str) : mData(str), mSize(strlen(str)) {}
+		StringView(const std::string& str) : mData(str.data()), mSize(str.size()) {}
 
-		if (opt.size() == 1)
-		{
-			return operator[](opt[0]);
-		}
+		constexpr const char* data() const { return mData; }
+		constexpr size_t size() const { return mSize; }
+		bool empty() const { return mSize == 0; }
+		char operator[](size_t i) const { return mData[i]; }
 
-		for (size_t i = 0; i < mDescriptors.size(); ++i)
-		{
-			if (mDescriptors[i].longName() == opt)
-			{
-				return &mDescriptors[i];
-			}
-		}
+		std::string str() const { return std::string(mData, mSize); }
 
-		return NULL;
-	}
+	private:
+		const char* mData;
+		size_t mSize;
+	};
 
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-	const OptionDescriptor* const OptionDescriptors::operator[](char opt) const
+	inline bool operator==(const StringView& a, const StringView& b)
 	{
-		for (size_t i = 0; i < mDescriptors.size(); ++i)
-		{
-			const char curOpt = mDescriptors[i].shortName();
-			if (curOpt == OPT_SHORT_NONE) continue;
-			if (curOpt == opt)
-			{
-				return &mDescriptors[i];
-			}
-		}
+		return a.size() == b.size() && !memcmp(a.data(), b.data(), a.size());
+	}
 
-		return NULL;
+	inline bool operator!=(const StringView& a, const StringView& b)
+	{
+		return !(a == b);
+	}
+
+	inline std::ostream& operator<<(std::ostream& stream, const StringView& view)
+	{
+		return stream.write(view.data(), view.size());
 	}
 
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 	/*------------------------------------------------------------------------------------------------*/
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-	class OptionValue
+	// Descriptor fields as seen by parsing, shared by OptionDescriptor (owning its
+	// names) and SchemaOption (names are string literals). The names are not owned.
+	class DescriptorView
 	{
 	public:
-		virtual const std::string asString() const { return ""; };
-		virtual double asReal() const { return 0; };
-		virtual int asInteger() const { return 0; };
-		virtual bool asBool() const { return true; };
+		constexpr char shortName() const { return mShortName; }
+		// The data is null terminated.
+		constexpr StringView longNameView() const { return StringView(mLongName, mLongNameSize); }
+		constexpr size_t longNameSize() const { return mLongNameSize; }
+		constexpr ArgType possibleArgumentValues() const { return mPossibleArgumentValues; }
+
+		// An argument of a vector value containing the delimiter holds the whole
+		// value, its elements separated by the delimiter. It may start with '-'
+		// only when attached with '='. Elements of ARG_INT_VEC can be ranges
+		// (1-1000, see LIST_RANGE_MAX), they are expanded on the first access of all values.
+		constexpr char listDelimiter() const { return mListDelimiter; }
+
+		// NULL without an environment variable. The value of the variable is read
+		// like one argument following the option (see Options), ARG_BOOL also
+		// accepts 1 and 0.
+		constexpr const char* environmentName() const { return mEnvironmentName; }
+
+	protected:
+		constexpr DescriptorView(char shortName, const char* longName, size_t longNameSize,
+			ArgType possibleArgumentValues, char listDelimiter, const char* environmentName)
+			: mShortName(shortName), mLongName(longName), mLongNameSize(longNameSize),
+			mPossibleArgumentValues(possibleArgumentValues),
+			mListDelimiter(listDelimiter),
+			mEnvironmentName(environmentName)
+		{}
 
-		virtual const std::vector<std::string> asStringVector() const
-		{
-			return std::vector<std::string>();
-		}
-		virtual const std::vector<double> asRealVector() const
-		{
-			return std::vector<double>();
-		}
-		virtual const std::vector<int> asIntegerVector() const
-		{
-			return std::vector<int>();
-		}
-		virtual const std::vector<bool> asBoolVector() const
-		{
-			return std::vector<bool>();
-		}
+	private:
+		const char mShortName;
+		const char* const mLongName;
+		const size_t mLongNameSize;
+		const ArgType mPossibleArgumentValues;
+		const char mListDelimiter;
+		const char* const mEnvironmentName;
+	};
 
-		virtual uint8_t type() const = 0;
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		operator bool() const { return type(); }
+	// Entry of a constexpr Schema table, the names are string literals:
+	//
+	//     constexpr sclap::SchemaOption kOptions[] = {
+	//         sclap::SchemaOption('t', "test", sclap::ARG_INT), ... };
+	class SchemaOption : public DescriptorView
+	{
+	public:
+		template <size_t L>
+		constexpr SchemaOption(const char shortName, const char (&longName)[L],
+			ArgType possibleArgumentValues, char listDelimiter = LIST_DELIMITER_NONE)
+			: DescriptorView(shortName, longName, L - 1, possibleArgumentValues, listDelimiter, NULL)
+		{}
 
-		virtual bool read(int& inOutCurIndex,
-			char** inOutCurArgumentStr, int argc, char** inArgv) = 0;
+		template <size_t L, size_t E>
+		constexpr SchemaOption(const char shortName, const char (&longName)[L],
+			ArgType possibleArgumentValues, char listDelimiter, const char (&environmentName)[E])
+			: DescriptorView(shortName, longName, L - 1, possibleArgumentValues, listDelimiter,
+				environmentName)
+		{}
 	};
 
-	uint8_t OptionValue::type() const {
-		return 0;
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	namespace hidden
+	{
+		// Names of an OptionDescriptor, a base class so they are constructed before
+		// the DescriptorView pointing to them.
+		struct DescriptorNames
+		{
+			DescriptorNames(const std::string& longName, const char* environmentName)
+				: mOwnedLongName(longName),
+				mOwnedEnvironmentName(environmentName ? environmentName : ""),
+				mHasEnvironment(environmentName != NULL)
+			{}
+
+			const std::string mOwnedLongName;
+			const std::string mOwnedEnvironmentName;
+			const bool mHasEnvironment;
+		};
 	}
 
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	class OptionDescriptor : private hidden::DescriptorNames, public DescriptorView
+	{
+	public:
+		// With a listDelimiter, vector values can also be packed into one argument
+		// (--ids=1,2,3), see listDelimiter(). With an environmentName, the option is
+		// read from that environment variable when it is not given in argv.
+		OptionDescriptor(const char shortName, const std::string& longName,
+			ArgType possibleArgumentValues, char listDelimiter = LIST_DELIMITER_NONE,
+			const char* environmentName = NULL)
+			: hidden::DescriptorNames(longName, environmentName),
+			DescriptorView(shortName, mOwnedLongName.c_str(), mOwnedLongName.size(),
+				possibleArgumentValues, listDelimiter,
+				mHasEnvironment ? mOwnedEnvironmentName.c_str() : NULL)
+		{}
+
+		// The copy points to its own names.
+		OptionDescriptor(const OptionDescriptor& desc)
+			: hidden::DescriptorNames(desc),
+			DescriptorView(desc.shortName(), mOwnedLongName.c_str(), mOwnedLongName.size(),
+				desc.possibleArgumentValues(), desc.listDelimiter(),
+				mHasEnvironment ? mOwnedEnvironmentName.c_str() : NULL)
+		{}
+
+		const std::string& longName() const { return mOwnedLongName; }
+	};
+
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 	/*------------------------------------------------------------------------------------------------*/
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
@@ -224,158 +382,3817 @@ namespace sclap
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 		/*--------------------------------------------------------------------------------------------*/
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
-		
-		template <typename T>
-		std::string numberToString(T Number)
+
+		// FNV-1a hash of the name (name is not required to be null terminated).
+		SCLAP_INLINE uint32_t hashName(const char* name, size_t size);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Same as hashName, usable in constant expressions.
+		constexpr uint32_t constHashName(const char* name, size_t size, uint32_t hash = 2166136261u)
 		{
-			std::ostringstream ss;
-			ss << Number;
-			return ss.str();
+			return size == 0 ? hash
+				: constHashName(name + 1, size - 1, (hash ^ (unsigned char)name[0]) * 16777619u);
 		}
 
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 		/*--------------------------------------------------------------------------------------------*/
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		bool toInteger(const char* s, int& val)
+		// Open addressing hash table mapping names to indices of an external container.
+		// Names are not stored in the table, candidates are compared through the Equal
+		// functor: bool operator()(int index, const char* name, size_t size).
+		template <typename Allocator>
+		class BasicNameIndex
 		{
-			if (s[0] == '\0' || ((!isdigit(s[0])) && (s[0] != '-') && (s[0] != '+'))) return false;
+		public:
+			static const int NONE = -1;
 
-			char* p;
-			val = strtol(s, &p, 10);
+			explicit BasicNameIndex(const Allocator& allocator = Allocator())
+				: mSlots(SlotAllocator(allocator)), mSize(0)
+			{}
 
-			return (*p == 0);
-		}
+			template <typename Equal>
+			int find(const char* name, size_t size, const Equal& equal) const;
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+			// Does nothing if the name is already in the table (first inserted wins).
+			template <typename Equal>
+			void insert(const char* name, size_t size, int index, const Equal& equal);
 
-		bool toDouble(const char* s, double& val)
-		{
-			char* end = NULL;
-			val = strtod(s, &end);
-			return end != s && *end == '\0';
-		}
+		private:
+			struct Slot
+			{
+				uint32_t hash;
+				int index;
+			};
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+			typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Slot> SlotAllocator;
 
-		bool isSingleArgType(uint8_t type)
-		{
-			return (type <= ARG_REAL) && type;
-		}
+			std::vector<Slot, SlotAllocator> mSlots;
+			size_t mSize;
+
+			void grow();
+		};
+
+		typedef BasicNameIndex<std::allocator<int> > NameIndex;
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
-		/*--------------------------------------------------------------------------------------------*/
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		bool readInt(int& inOutCurIndex, char** inOutCurArgumentStr,
-			char** inArgv, int &outInteger)
+		template <typename Allocator>
+		template <typename Equal>
+		int BasicNameIndex<Allocator>::find(const char* name, size_t size, const Equal& equal) const
 		{
-			bool res = hidden::toInteger(*inOutCurArgumentStr, outInteger);
-			if (res)
+			if (mSlots.empty()) return NONE;
+
+			const uint32_t hash = hashName(name, size);
+			const size_t mask = mSlots.size() - 1;
+			for (size_t i = hash & mask; mSlots[i].index != NONE; i = (i + 1) & mask)
 			{
-				++inOutCurIndex;
-				*inOutCurArgumentStr = inArgv[inOutCurIndex];
+				SCLAP_STAT(addStat(&ParseStats::probes, 1));
+				if (mSlots[i].hash == hash && equal(mSlots[i].index, name, size))
+				{
+					return mSlots[i].index;
+				}
 			}
-			return res;
+
+			return NONE;
 		}
 
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		bool readDouble(int& inOutCurIndex, char** inOutCurArgumentStr,
-			char** inArgv, double &outDouble)
+		template <typename Allocator>
+		template <typename Equal>
+		void BasicNameIndex<Allocator>::insert(const char* name, size_t size, int index, const Equal& equal)
 		{
-			bool res = hidden::toDouble(*inOutCurArgumentStr, outDouble);
-			if (res)
-			{
-				++inOutCurIndex;
-				*inOutCurArgumentStr = inArgv[inOutCurIndex];
-			}
-			return res;
+			if (find(name, size, equal) != NONE) return;
+
+			// keep load factor below 1/2
+			if ((mSize + 1) * 2 > mSlots.size()) grow();
+
+			const uint32_t hash = hashName(name, size);
+			const size_t mask = mSlots.size() - 1;
+			size_t i = hash & mask;
+			while (mSlots[i].index != NONE) i = (i + 1) & mask;
+
+			mSlots[i].hash = hash;
+			mSlots[i].index = index;
+			++mSize;
 		}
 
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		bool readString(int& inOutCurIndex, char** inOutCurArgumentStr,
-			char** inArgv, std::string &outString)
+		template <typename Allocator>
+		void BasicNameIndex<Allocator>::grow()
 		{
-			if (**inOutCurArgumentStr != '\0')
-			{
-				outString = std::string(*inOutCurArgumentStr);
-				++inOutCurIndex;
-				*inOutCurArgumentStr = inArgv[inOutCurIndex];
-			}
-			else
+			const Slot empty = { 0, NONE };
+			std::vector<Slot, SlotAllocator> slots(mSlots.empty() ? 16 : mSlots.size() * 2, empty,
+				mSlots.get_allocator());
+
+			const size_t mask = slots.size() - 1;
+			for (size_t j = 0; j < mSlots.size(); ++j)
 			{
-				return false;
+				if (mSlots[j].index == NONE) continue;
+
+				size_t i = mSlots[j].hash & mask;
+				while (slots[i].index != NONE) i = (i + 1) & mask;
+				slots[i] = mSlots[j];
 			}
-			return true;
+
+			mSlots.swap(slots);
 		}
 
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 		/*--------------------------------------------------------------------------------------------*/
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		uint8_t getTypeToRead(uint8_t single, uint8_t vector)
+		struct DescriptorLongNameEqual
 		{
-			if (vector == ARG_REAL_VEC) return ARG_REAL_VEC;
-			else if (vector == ARG_INT_VEC) {
-				  if (single == ARG_REAL) return ARG_REAL_VEC;
-				  else return ARG_INT_VEC;
-			}
-			else if (vector == ARG_BOOL_VEC)
+			const std::vector<OptionDescriptor>& descriptors;
+
+			bool operator()(int index, const char* name, size_t size) const
 			{
-				if (single == ARG_REAL) return ARG_REAL_VEC;
-				else if (single == ARG_INT) return ARG_INT_VEC;
-				else return ARG_BOOL_VEC;
-			}
-			else if (vector == ARG_STRING_VEC) {
-				if (single == ARG_REAL) return ARG_REAL_VEC;
-				else if (single == ARG_INT) return ARG_INT_VEC;
-				else return ARG_STRING_VEC;
+				const OptionDescriptor& desc = descriptors[index];
+				return desc.longNameSize() == size && !memcmp(desc.longNameView().data(), name, size);
 			}
-			else return single;
-		}
+		};
+	}
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
-		/*--------------------------------------------------------------------------------------------*/
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		class OptionValueUnexisted : public OptionValue
-		{
-		public:
-			virtual bool asBool() const { return false; }
+	enum ErrorCode
+	{
+		ERROR_LONG_NAME_LENGTH,      // descriptor with a long name of one character
+		ERROR_NOT_AN_OPTION,         // --name is not described
+		ERROR_ZERO_LENGTH_OPTION,    // -- without a name
+		ERROR_UNKNOWN_SHORT_OPTION,  // -x is not described
+		ERROR_REPEATED_SHORT_OPTION, // -xx
+		ERROR_OPTION_EXPECTED,       // argument which is not an option
+		ERROR_READ_ARGUMENT,         // value which can not be read as the type of the option
+		ERROR_RESPONSE_FILE,         // @path which can not be read
+		ERROR_ENVIRONMENT,           // NAME with a value which can not be read as the type of the option
+		ERROR_CONFIG_FILE,           // config file path which can not be read
+		ERROR_CONFIG_LINE,           // config file line with an unknown option or an unreadable value
+		ERROR_WIDE_SHARED_ARGUMENT   // 64 bit option sharing an argument with a vector, real or
+		                             // other numeric option which can not read its value (-ov)
+	};
 
-			virtual uint8_t type() const { return UNEXISTED; }
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-			virtual bool read(int& inOutCurIndex, char** inOutCurArgumentStr,
-				int argc, char** inArgv) { return false; }
-		};
+	// Record of an error, the text is made only by str(). Nothing is allocated
+	// until an error occurs.
+	struct Error
+	{
+		ErrorCode code;
+		// the option name, argument or path the error is about
+		std::string subject;
+		// position in argv or line of a config file (-1 for descriptor and environment
+		// errors) and byte offset in the argument or line
+		int argumentIndex;
+		size_t offset;
+
+		std::string str() const;
+	};
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	namespace hidden
+	{
+		inline Error makeError(ErrorCode code, const char* subject, size_t size,
+			int argumentIndex, size_t offset)
+		{
+			const Error error = { code, std::string(subject, size), argumentIndex, offset };
+			return error;
+		}
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
-		/*--------------------------------------------------------------------------------------------*/
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		class OptionValueBool : public OptionValue
+		SCLAP_INLINE std::string formatErrors(const std::vector<Error>& errors);
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Interface of descriptor lookup used by Options.
+	// Implemented by OptionDescriptors (built at runtime) and Schema (built at compile time).
+	class DescriptorSet
+	{
+	public:
+		const DescriptorView* const operator[](const std::string& opt) const
 		{
-		public:
-			virtual const std::string asString() const { return mValue ? "true" : "false"; };
+			return find(opt.data(), opt.size());
+		}
+		const DescriptorView* const operator[](char opt) const { return findShort(opt); }
 
-			virtual uint8_t type() const { return ARG_BOOL; }
+		// Short option if size is 1, long option otherwise.
+		const DescriptorView* find(const char* opt, size_t size) const;
 
-			virtual bool read(int& inOutCurIndex, char** inOutCurArgumentStr,
-				int argc, char** inArgv);
+		virtual const DescriptorView* findShort(char opt) const = 0;
+		virtual const DescriptorView* findLong(const char* opt, size_t size) const = 0;
 
-			virtual bool asBool() const { return mValue; };
+		// Descriptors with an environment name, in declaration order.
+		virtual size_t environmentSize() const = 0;
+		virtual const DescriptorView& environmentDescriptor(size_t i) const = 0;
 
-		private:
-			bool mValue;
-		};
+		virtual bool valid() const = 0;
+		virtual const std::vector<Error>& errors() const = 0;
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		std::string error() const { return hidden::formatErrors(errors()); }
 
-		bool OptionValueBool::read(int& inOutCurIndex, char** inOutCurArgumentStr,
-			int argc, char** inArgv)
-		{
+	protected:
+		// Not virtual and trivial, so Schema stays a literal type.
+		~DescriptorSet() = default;
+	};
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	class CompiledDescriptors;
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	class OptionDescriptors : public DescriptorSet
+	{
+	public:
+		OptionDescriptors(const std::vector<OptionDescriptor>& descriptors);
+		OptionDescriptors() : mDescriptors(), mErrors(), mOk(true) { clearIndex(); }
+		OptionDescriptors(const OptionDescriptors& optDesc);
+
+		const OptionDescriptor* const operator[](const std::string& opt) const
+		{
+			return static_cast<const OptionDescriptor*>(find(opt.data(), opt.size()));
+		}
+		const OptionDescriptor* const operator[](char opt) const
+		{
+			return static_cast<const OptionDescriptor*>(findShort(opt));
+		}
+
+		virtual const DescriptorView* findShort(char opt) const;
+		virtual const DescriptorView* findLong(const char* opt, size_t size) const;
+
+		virtual size_t environmentSize() const { return mEnvironment.size(); }
+		virtual const DescriptorView& environmentDescriptor(size_t i) const
+		{
+			return mDescriptors[mEnvironment[i]];
+		}
+
+		virtual bool valid() const { return mOk; }
+		virtual const std::vector<Error>& errors() const { return mErrors; }
+
+		OptionDescriptors& operator<<(const OptionDescriptor& OptionDescriptor)
+		{
+			add(OptionDescriptor);
+			check(mDescriptors.size() - 1);
+			return *this;
+		}
+
+		// Immutable copy to share between Options (see CompiledDescriptors).
+		std::shared_ptr<const CompiledDescriptors> compile() const;
+
+	private:
+		friend class CompiledDescriptors;
+
+		std::vector<OptionDescriptor> mDescriptors;
+
+		// Lookup tables into mDescriptors, updated on every insertion.
+		int mShortIndex[256];
+		hidden::NameIndex mLongIndex;
+		// positions of the descriptors with an environment name
+		std::vector<int> mEnvironment;
+
+		std::vector<Error> mErrors;
+		bool mOk;
+
+		void check(size_t first);
+		void clearIndex();
+		void add(const OptionDescriptor& desc);
+	};
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Frozen OptionDescriptors: the lookup tables are built once. Nothing can be added,
+	// so any number of Options (also on different threads) can share one instance
+	// instead of copying the descriptors:
+	//
+	//     std::shared_ptr<const sclap::CompiledDescriptors> compiled = descriptors.compile();
+	//     sclap::Options options(compiled, argc, argv);
+	class CompiledDescriptors : public DescriptorSet
+	{
+	public:
+		explicit CompiledDescriptors(const OptionDescriptors& descriptors);
+		CompiledDescriptors(const CompiledDescriptors&) = delete;
+		CompiledDescriptors& operator=(const CompiledDescriptors&) = delete;
+
+		const OptionDescriptor* const operator[](const std::string& opt) const
+		{
+			return static_cast<const OptionDescriptor*>(find(opt.data(), opt.size()));
+		}
+		const OptionDescriptor* const operator[](char opt) const
+		{
+			return static_cast<const OptionDescriptor*>(findShort(opt));
+		}
+
+		virtual const DescriptorView* findShort(char opt) const;
+		virtual const DescriptorView* findLong(const char* opt, size_t size) const;
+
+		virtual size_t environmentSize() const { return mEnvironment.size(); }
+		virtual const DescriptorView& environmentDescriptor(size_t i) const
+		{
+			return mDescriptors[mEnvironment[i]];
+		}
+
+		virtual bool valid() const { return mOk; }
+		virtual const std::vector<Error>& errors() const { return mErrors; }
+
+		size_t size() const { return mDescriptors.size(); }
+
+	private:
+		// never reallocated after construction, Options point to the names
+		std::vector<OptionDescriptor> mDescriptors;
+
+		int mShortIndex[256];
+		hidden::NameIndex mLongIndex;
+		std::vector<int> mEnvironment;
+
+		const std::vector<Error> mErrors;
+		const bool mOk;
+	};
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	namespace hidden
+	{
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Compile time helpers of Schema. Recursion is split in halves everywhere,
+		// so the constexpr depth stays logarithmic in the number of descriptors.
+
+		template <size_t... I>
+		struct IndexSequence {};
+
+		template <typename Left, typename Right>
+		struct ConcatIndexSequence;
+
+		template <size_t... I, size_t... J>
+		struct ConcatIndexSequence<IndexSequence<I...>, IndexSequence<J...> >
+		{
+			typedef IndexSequence<I..., (sizeof...(I) + J)...> type;
+		};
+
+		template <size_t N>
+		struct MakeIndexSequence
+		{
+			typedef typename ConcatIndexSequence<typename MakeIndexSequence<N / 2>::type,
+				typename MakeIndexSequence<N - N / 2>::type>::type type;
+		};
+
+		template <>
+		struct MakeIndexSequence<0> { typedef IndexSequence<> type; };
+
+		template <>
+		struct MakeIndexSequence<1> { typedef IndexSequence<0> type; };
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Static array filled with Builder::value(0) ... Builder::value(N - 1).
+		template <typename T, typename Builder, typename Sequence>
+		struct StaticTable;
+
+		template <typename T, typename Builder, size_t... I>
+		struct StaticTable<T, Builder, IndexSequence<I...> >
+		{
+			static constexpr T values[sizeof...(I)] = { Builder::value(I)... };
+		};
+
+		template <typename T, typename Builder, size_t... I>
+		constexpr T StaticTable<T, Builder, IndexSequence<I...> >::values[sizeof...(I)];
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		constexpr bool constEqual(const char* a, const char* b, size_t size)
+		{
+			return size == 0 ? true
+				: size == 1 ? a[0] == b[0]
+				: constEqual(a, b, size / 2) && constEqual(a + size / 2, b + size / 2, size - size / 2);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		constexpr size_t nextPowerOfTwo(size_t n, size_t p = 1)
+		{
+			return p >= n ? p : nextPowerOfTwo(n, p * 2);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Returns first if it is a found index, else second.
+		constexpr int firstFound(int first, int second)
+		{
+			return first != NameIndex::NONE ? first : second;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		constexpr bool sameLongName(const SchemaOption* t, const uint32_t* hashes, size_t i, size_t j)
+		{
+			return hashes[i] == hashes[j] && t[i].longNameSize() == t[j].longNameSize()
+				&& constEqual(t[i].longNameView().data(), t[j].longNameView().data(), t[i].longNameSize());
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Some descriptor in [begin, end) has a short name first given to another one.
+		constexpr bool anyRepeatedShortName(const SchemaOption* t, const int* shortIndex,
+			size_t begin, size_t end)
+		{
+			return begin == end ? false
+				: end - begin == 1 ? t[begin].shortName() != OPT_SHORT_NONE
+					&& shortIndex[(unsigned char)t[begin].shortName()] != (int)begin
+				: anyRepeatedShortName(t, shortIndex, begin, begin + (end - begin) / 2)
+				|| anyRepeatedShortName(t, shortIndex, begin + (end - begin) / 2, end);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// First descriptor from j on in the bucket chain of i with the long name of i.
+		constexpr int findInChain(const SchemaOption* t, const uint32_t* hashes, const int* next,
+			int j, size_t i)
+		{
+			return j == NameIndex::NONE || sameLongName(t, hashes, (size_t)j, i) ? j
+				: findInChain(t, hashes, next, next[j], i);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Some descriptor in [begin, end) has a long name first given to another one.
+		// Only the bucket chain of every name is searched.
+		constexpr bool anyRepeatedLongName(const SchemaOption* t, const uint32_t* hashes,
+			const int* buckets, const int* heads, const int* next, size_t begin, size_t end)
+		{
+			return begin == end ? false
+				: end - begin == 1 ? buckets[begin] != NameIndex::NONE
+					&& findInChain(t, hashes, next, heads[buckets[begin]], begin) != (int)begin
+				: anyRepeatedLongName(t, hashes, buckets, heads, next, begin, begin + (end - begin) / 2)
+				|| anyRepeatedLongName(t, hashes, buckets, heads, next, begin + (end - begin) / 2, end);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		constexpr bool anyLongNameOfLengthOne(const SchemaOption* t, size_t begin, size_t end)
+		{
+			return begin == end ? false
+				: end - begin == 1 ? t[begin].longNameSize() == 1
+				: anyLongNameOfLengthOne(t, begin, begin + (end - begin) / 2)
+				|| anyLongNameOfLengthOne(t, begin + (end - begin) / 2, end);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		constexpr int findShortName(const SchemaOption* t, size_t begin, size_t end, char opt)
+		{
+			return begin == end || opt == OPT_SHORT_NONE ? NameIndex::NONE
+				: end - begin == 1 ? (t[begin].shortName() == opt ? (int)begin : NameIndex::NONE)
+				: firstFound(findShortName(t, begin, begin + (end - begin) / 2, opt),
+					findShortName(t, begin + (end - begin) / 2, end, opt));
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// First index in [begin, end) placed into the bucket.
+		constexpr int findInBucket(const int* buckets, size_t begin, size_t end, int bucket)
+		{
+			return begin == end ? NameIndex::NONE
+				: end - begin == 1 ? (buckets[begin] == bucket ? (int)begin : NameIndex::NONE)
+				: firstFound(findInBucket(buckets, begin, begin + (end - begin) / 2, bucket),
+					findInBucket(buckets, begin + (end - begin) / 2, end, bucket));
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		constexpr size_t countEnvironment(const SchemaOption* t, size_t begin, size_t end)
+		{
+			return begin == end ? 0
+				: end - begin == 1 ? (t[begin].environmentName() != NULL ? 1 : 0)
+				: countEnvironment(t, begin, begin + (end - begin) / 2)
+					+ countEnvironment(t, begin + (end - begin) / 2, end);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Index of the n-th descriptor in [begin, end) with an environment name.
+		constexpr int findEnvironment(const SchemaOption* t, size_t begin, size_t end, size_t n)
+		{
+			return begin == end ? NameIndex::NONE
+				: end - begin == 1 ? (n == 0 && t[begin].environmentName() != NULL ? (int)begin : NameIndex::NONE)
+				: n < countEnvironment(t, begin, begin + (end - begin) / 2)
+				? findEnvironment(t, begin, begin + (end - begin) / 2, n)
+				: findEnvironment(t, begin + (end - begin) / 2, end,
+					n - countEnvironment(t, begin, begin + (end - begin) / 2));
+		}
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Largest table of a Schema. The bucket chains of the long names are built with
+	// a quadratic number of constexpr steps, larger tables would exceed the constexpr
+	// limits of compilers; use OptionDescriptors for them.
+	const size_t SCHEMA_MAX_SIZE = 256;
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Descriptor set declared at compile time from a constexpr table:
+	//
+	//     constexpr sclap::SchemaOption kOptions[] = {
+	//         sclap::SchemaOption('t', "test", sclap::ARG_INT), ... };
+	//     const sclap::Schema<sizeof(kOptions) / sizeof(*kOptions), kOptions> schema;
+	//
+	// Duplicate names are compile errors, lookup tables are generated at compile time,
+	// so nothing is allocated or validated at runtime. At most SCHEMA_MAX_SIZE entries.
+	template <size_t N, const SchemaOption (&Table)[N]>
+	class Schema : public DescriptorSet
+	{
+	public:
+		constexpr Schema() {}
+
+		virtual const DescriptorView* findShort(char opt) const;
+		virtual const DescriptorView* findLong(const char* opt, size_t size) const;
+
+		virtual size_t environmentSize() const { return ENVIRONMENT_SIZE; }
+		virtual const DescriptorView& environmentDescriptor(size_t i) const;
+
+		virtual bool valid() const { return true; }
+		virtual const std::vector<Error>& errors() const
+		{
+			static const std::vector<Error> none;
+			return none;
+		}
+
+	private:
+		static_assert(N <= SCHEMA_MAX_SIZE, "Schema table larger than SCHEMA_MAX_SIZE.");
+
+		static const uint32_t BUCKETS = hidden::nextPowerOfTwo(N);
+
+		struct HashBuilder
+		{
+			static constexpr uint32_t value(size_t i)
+			{
+				return hidden::constHashName(Table[i].longNameView().data(), Table[i].longNameSize());
+			}
+		};
+		typedef hidden::StaticTable<uint32_t, HashBuilder,
+			typename hidden::MakeIndexSequence<N>::type> Hashes;
+
+		static_assert(!hidden::anyLongNameOfLengthOne(Table, 0, N),
+			"Long option length cant be 1.");
+
+		struct ShortBuilder
+		{
+			static constexpr int value(size_t opt)
+			{
+				return hidden::findShortName(Table, 0, N, (char)opt);
+			}
+		};
+		typedef hidden::StaticTable<int, ShortBuilder,
+			typename hidden::MakeIndexSequence<256>::type> ShortIndex;
+
+		// Chained hash table: bucket of every descriptor (NONE without long name),
+		// first descriptor of every bucket and next one in the same bucket.
+		struct BucketBuilder
+		{
+			static constexpr int value(size_t i)
+			{
+				return Table[i].longNameSize() ? (int)(Hashes::values[i] & (BUCKETS - 1))
+					: hidden::NameIndex::NONE;
+			}
+		};
+		typedef hidden::StaticTable<int, BucketBuilder,
+			typename hidden::MakeIndexSequence<N>::type> Buckets;
+
+		struct HeadBuilder
+		{
+			static constexpr int value(size_t bucket)
+			{
+				return hidden::findInBucket(Buckets::values, 0, N, (int)bucket);
+			}
+		};
+		typedef hidden::StaticTable<int, HeadBuilder,
+			typename hidden::MakeIndexSequence<BUCKETS>::type> Heads;
+
+		struct NextBuilder
+		{
+			static constexpr int value(size_t i)
+			{
+				return Buckets::values[i] == hidden::NameIndex::NONE ? hidden::NameIndex::NONE
+					: hidden::findInBucket(Buckets::values, i + 1, N, Buckets::values[i]);
+			}
+		};
+		typedef hidden::StaticTable<int, NextBuilder,
+			typename hidden::MakeIndexSequence<N>::type> Next;
+
+		// a repeated name is not the first one of its short index entry or bucket chain
+		static_assert(!hidden::anyRepeatedShortName(Table, ShortIndex::values, 0, N),
+			"Multiple option descriptors with the same short option.");
+		static_assert(!hidden::anyRepeatedLongName(Table, Hashes::values, Buckets::values,
+			Heads::values, Next::values, 0, N),
+			"Multiple option descriptors with the same long option.");
+
+		static const size_t ENVIRONMENT_SIZE = hidden::countEnvironment(Table, 0, N);
+
+		struct EnvironmentBuilder
+		{
+			static constexpr int value(size_t i)
+			{
+				return ENVIRONMENT_SIZE ? hidden::findEnvironment(Table, 0, N, i) : 0;
+			}
+		};
+		// a static array can not be empty, without environment names it holds the
+		// valid but unused index 0
+		typedef hidden::StaticTable<int, EnvironmentBuilder,
+			typename hidden::MakeIndexSequence<ENVIRONMENT_SIZE ? ENVIRONMENT_SIZE : 1>::type> Environment;
+	};
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	template <size_t N, const SchemaOption (&Table)[N]>
+	const DescriptorView* Schema<N, Table>::findShort(char opt) const
+	{
+		const int i = ShortIndex::values[(unsigned char)opt];
+
+		return i == hidden::NameIndex::NONE ? NULL : &Table[i];
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	template <size_t N, const SchemaOption (&Table)[N]>
+	const DescriptorView* Schema<N, Table>::findLong(const char* opt, size_t size) const
+	{
+		const uint32_t hash = hidden::hashName(opt, size);
+
+		for (int i = Heads::values[hash & (BUCKETS - 1)];
+			i != hidden::NameIndex::NONE;
+			i = Next::values[i])
+		{
+			if (Hashes::values[i] == hash && Table[i].longNameSize() == size
+				&& !memcmp(Table[i].longNameView().data(), opt, size))
+			{
+				return &Table[i];
+			}
+		}
+
+		return NULL;
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	template <size_t N, const SchemaOption (&Table)[N]>
+	const DescriptorView& Schema<N, Table>::environmentDescriptor(size_t i) const
+	{
+		return Table[Environment::values[i < ENVIRONMENT_SIZE ? i : 0]];
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Monotonic memory arena (same idea as std::pmr::monotonic_buffer_resource).
+	// Allocation bumps a pointer, deallocation does nothing, release() frees everything
+	// at once. Starts in the optional user supplied buffer and continues in heap blocks
+	// of growing size. Not thread safe.
+	class Arena
+	{
+	public:
+		Arena(void* buffer, size_t size)
+			: mBuffer((char*)buffer), mBufferSize(size), mBlocks(NULL), mBlockSize(size)
+		{
+			release();
+		}
+
+		explicit Arena(size_t blockSize = 4096)
+			: mBuffer(NULL), mBufferSize(0), mBlocks(NULL), mBlockSize(blockSize)
+		{
+			release();
+		}
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		~Arena() { release(); }
+
+		void* allocate(size_t size, size_t alignment);
+
+		// Frees heap blocks and rewinds to the start of the user buffer. Block sizes
+		// start growing from the initial size again.
+		void release();
+
+	private:
+		struct Block
+		{
+			Block* next;
+			size_t size;
+		};
+
+		char* mBuffer;
+		size_t mBufferSize;
+
+		char* mCur;
+		char* mEnd;
+
+		Block* mBlocks;
+		const size_t mBlockSize;
+		size_t mNextBlockSize;
+	};
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	namespace hidden
+	{
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Standard allocator allocating from an Arena, or from the heap without one.
+		template <typename T>
+		class ArenaAllocator
+		{
+		public:
+			typedef T value_type;
+
+			ArenaAllocator(Arena* arena = NULL) : mArena(arena) {}
+
+			template <typename U>
+			ArenaAllocator(const ArenaAllocator<U>& other) : mArena(other.arena()) {}
+
+			T* allocate(size_t n)
+			{
+				if (mArena) return (T*)mArena->allocate(n * sizeof(T), alignof(T));
+
+				SCLAP_STAT(addStat(&ParseStats::allocations, 1));
+				SCLAP_STAT(addStat(&ParseStats::allocatedBytes, n * sizeof(T)));
+				return (T*)::operator new(n * sizeof(T));
+			}
+
+			void deallocate(T* ptr, size_t)
+			{
+				if (!mArena) ::operator delete(ptr);
+			}
+
+			Arena* arena() const { return mArena; }
+
+		private:
+			Arena* mArena;
+		};
+
+		template <typename T, typename U>
+		bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+		{
+			return a.arena() == b.arena();
+		}
+
+		template <typename T, typename U>
+		bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+		{
+			return a.arena() != b.arena();
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char> > String;
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Growable contiguous storage of trivially copyable values. Unlike std::vector
+		// it is contiguous for bool too.
+		template <typename T>
+		class Buffer
+		{
+		public:
+			typedef T value_type;
+
+			Buffer(Arena* arena) : mAllocator(arena), mData(NULL), mSize(0), mCapacity(0) {}
+			Buffer(const Buffer&) = delete;
+			Buffer& operator=(const Buffer&) = delete;
+
+			~Buffer()
+			{
+				if (mData) mAllocator.deallocate(mData, mCapacity);
+			}
+
+			T* data() { return mData; }
+			const T* data() const { return mData; }
+			size_t size() const { return mSize; }
+			bool empty() const { return mSize == 0; }
+			const T& operator[](size_t i) const { return mData[i]; }
+
+			void clear() { mSize = 0; }
+			void reserve(size_t capacity);
+
+			void push_back(const T& value)
+			{
+				if (mSize == mCapacity) reserve(mCapacity ? mCapacity * 2 : 8);
+				mData[mSize++] = value;
+			}
+
+		private:
+			ArenaAllocator<T> mAllocator;
+			T* mData;
+			size_t mSize;
+			size_t mCapacity;
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		template <typename T>
+		void Buffer<T>::reserve(size_t capacity)
+		{
+			if (capacity <= mCapacity) return;
+
+			T* data = mAllocator.allocate(capacity);
+			if (mData)
+			{
+				memcpy(data, mData, mSize * sizeof(T));
+				mAllocator.deallocate(mData, mCapacity);
+			}
+
+			mData = data;
+			mCapacity = capacity;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Objects created in an arena are never destroyed: their members allocate
+		// from the same arena, so there is nothing to free before Arena::release().
+		template <typename T, typename... Args>
+		T* create(Arena* arena, Args&&... args)
+		{
+			if (arena)
+			{
+				return new (arena->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+			}
+
+			SCLAP_STAT(addStat(&ParseStats::allocations, 1));
+			SCLAP_STAT(addStat(&ParseStats::allocatedBytes, sizeof(T)));
+			return new T(std::forward<Args>(args)...);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		template <typename T>
+		void destroy(Arena* arena, T* ptr)
+		{
+			if (!arena) delete ptr;
+		}
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Non owning reference to contiguous values.
+	template <typename T>
+	class Span
+	{
+	public:
+		typedef const T* const_iterator;
+
+		Span() : mData(NULL), mSize(0) {}
+		Span(const T* data, size_t size) : mData(data), mSize(size) {}
+
+		const T* data() const { return mData; }
+		size_t size() const { return mSize; }
+		bool empty() const { return mSize == 0; }
+		const T& operator[](size_t i) const { return mData[i]; }
+
+		const T* begin() const { return mData; }
+		const T* end() const { return mData + mSize; }
+
+	private:
+		const T* mData;
+		size_t mSize;
+	};
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Flags of Options parsing.
+	const uint32_t PARSE_DEFAULT   = 0;
+	// String values reference argv instead of copying it, argv must outlive Options.
+	const uint32_t PARSE_ZERO_COPY = 1 << 0;
+	// Arguments of the form @path are replaced by the tokens of the file at path
+	// (see hidden::nextToken). Files are mapped for the lifetime of Options, so
+	// with PARSE_ZERO_COPY string values reference the mapping.
+	const uint32_t PARSE_RESPONSE_FILES = 1 << 1;
+	// Parsing only records the arguments of each option, they are converted on
+	// the first access and kept. Conversion errors are reported by Option::valid()
+	// instead of Options::valid(). argv must outlive Options.
+	const uint32_t PARSE_LAZY = 1 << 2;
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	namespace hidden
+	{
+		// Private writable mapping of a file followed by a zero byte. Writes are not
+		// visible in the file. Without mmap (Windows) the file is read to the heap.
+		class MappedFile
+		{
+		public:
+			MappedFile() : mData(NULL), mSize(0), mMappedSize(0) {}
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+			~MappedFile() { close(); }
+
+			bool open(const char* path);
+			void close();
+
+			char* data() { return mData; }
+			size_t size() const { return mSize; }
+
+		private:
+			char* mData;
+			size_t mSize;
+			size_t mMappedSize;
+		};
+
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		inline bool isSpace(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		inline bool isTokenBreak(char c)
+		{
+			return isSpace(c) || c == '\'' || c == '"' || c == '\\';
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// First whitespace, quote or backslash of [cur, end), end if there is none.
+		inline const char* findTokenBreakScalar(const char* cur, const char* end)
+		{
+			while (cur != end && !isTokenBreak(*cur)) ++cur;
+			return cur;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+#if defined(SCLAP_AVX2) || defined(SCLAP_SSE2)
+		inline unsigned lowestBit(uint32_t mask)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return (unsigned)index;
+#else
+			return (unsigned)__builtin_ctz(mask);
+#endif
+		}
+#endif
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Same as findTokenBreakScalar, 32 (AVX2) or 16 (SSE2) characters at a time.
+		inline const char* findTokenBreak(const char* cur, const char* end)
+		{
+#if defined(SCLAP_AVX2)
+			// '\t'..'\r' are 9..13: c - 9 <= 4 unsigned
+			const __m256i controlBase = _mm256_set1_epi8(9);
+			const __m256i controlLast = _mm256_set1_epi8(4);
+			const __m256i space = _mm256_set1_epi8(' ');
+			const __m256i single = _mm256_set1_epi8('\'');
+			const __m256i dquote = _mm256_set1_epi8('"');
+			const __m256i backslash = _mm256_set1_epi8('\\');
+			while (end - cur >= 32)
+			{
+				const __m256i v = _mm256_loadu_si256((const __m256i*)cur);
+				const __m256i control = _mm256_sub_epi8(v, controlBase);
+				__m256i breaks = _mm256_cmpeq_epi8(_mm256_min_epu8(control, controlLast), control);
+				breaks = _mm256_or_si256(breaks, _mm256_cmpeq_epi8(v, space));
+				breaks = _mm256_or_si256(breaks, _mm256_cmpeq_epi8(v, single));
+				breaks = _mm256_or_si256(breaks, _mm256_cmpeq_epi8(v, dquote));
+				breaks = _mm256_or_si256(breaks, _mm256_cmpeq_epi8(v, backslash));
+
+				const uint32_t mask = (uint32_t)_mm256_movemask_epi8(breaks);
+				if (mask) return cur + lowestBit(mask);
+				cur += 32;
+			}
+#elif defined(SCLAP_SSE2)
+			const __m128i controlBase = _mm_set1_epi8(9);
+			const __m128i controlLast = _mm_set1_epi8(4);
+			const __m128i space = _mm_set1_epi8(' ');
+			const __m128i single = _mm_set1_epi8('\'');
+			const __m128i dquote = _mm_set1_epi8('"');
+			const __m128i backslash = _mm_set1_epi8('\\');
+			while (end - cur >= 16)
+			{
+				const __m128i v = _mm_loadu_si128((const __m128i*)cur);
+				const __m128i control = _mm_sub_epi8(v, controlBase);
+				__m128i breaks = _mm_cmpeq_epi8(_mm_min_epu8(control, controlLast), control);
+				breaks = _mm_or_si128(breaks, _mm_cmpeq_epi8(v, space));
+				breaks = _mm_or_si128(breaks, _mm_cmpeq_epi8(v, single));
+				breaks = _mm_or_si128(breaks, _mm_cmpeq_epi8(v, dquote));
+				breaks = _mm_or_si128(breaks, _mm_cmpeq_epi8(v, backslash));
+
+				const uint32_t mask = (uint32_t)_mm_movemask_epi8(breaks);
+				if (mask) return cur + lowestBit(mask);
+				cur += 16;
+			}
+#endif
+			return findTokenBreakScalar(cur, end);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Returns the next whitespace separated token of [inOutCur, end) or NULL at
+		// the end. The token is unquoted and terminated by '\0' in place, *end must
+		// be writable. '...' is literal, "..." and unquoted text treat a backslash
+		// as an escape of the next character. An unterminated quote ends at end.
+		// Text between quotes and escapes is found with findTokenBreak and moved
+		// as a whole.
+		SCLAP_INLINE char* nextToken(char*& inOutCur, char* end);
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// argc and argv of a whole command line string, e.g. from a config field. The
+	// string is split in place with the quoting of response files (see
+	// hidden::nextToken), the first token is the program name. The string must be
+	// writable up to and including line[size] and outlive the arguments and the
+	// Options parsed from them.
+	class CommandLineArguments
+	{
+	public:
+		CommandLineArguments(char* line, size_t size, Arena* arena = NULL)
+			: mArguments(arena)
+		{
+			split(line, size);
+		}
+
+		// line is null terminated.
+		explicit CommandLineArguments(char* line, Arena* arena = NULL)
+			: mArguments(arena)
+		{
+			split(line, strlen(line));
+		}
+
+		CommandLineArguments(const CommandLineArguments&) = delete;
+		CommandLineArguments& operator=(const CommandLineArguments&) = delete;
+
+		int argc() const { return (int)mArguments.size() - 1; }
+		// Terminated by NULL like argv of main.
+		char** argv() { return mArguments.data(); }
+
+	private:
+		hidden::Buffer<char*> mArguments;
+
+		void split(char* line, size_t size)
+		{
+			char* cur = line;
+			char* end = line + size;
+			while (char* token = hidden::nextToken(cur, end))
+			{
+				mArguments.push_back(token);
+			}
+			mArguments.push_back(NULL);
+		}
+	};
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	class OptionValue
+	{
+	public:
+		virtual ~OptionValue() {}
+
+		virtual const std::string asString() const { return ""; };
+		virtual double asReal() const { return 0; };
+		virtual int asInteger() const { return 0; };
+		virtual bool asBool() const { return true; };
+		// Same as asInteger() unless the value is wider than int.
+		virtual int64_t asInt64() const { return asInteger(); }
+		virtual uint64_t asUInt64() const { return (uint64_t)asInt64(); }
+
+		virtual const std::vector<std::string> asStringVector() const
+		{
+			return std::vector<std::string>();
+		}
+		virtual const std::vector<double> asRealVector() const
+		{
+			return std::vector<double>();
+		}
+		virtual const std::vector<float> asFloatVector() const
+		{
+			return std::vector<float>();
+		}
+		virtual const std::vector<int> asIntegerVector() const
+		{
+			return std::vector<int>();
+		}
+		virtual const std::vector<bool> asBoolVector() const
+		{
+			return std::vector<bool>();
+		}
+
+		// Views of the stored strings, empty for values which are not strings.
+		virtual StringView asStringView() const { return StringView(); }
+		virtual Span<StringView> asStringViews() const { return Span<StringView>(); }
+
+		// Same content as the vector accessors without copying, empty exactly
+		// when they are. Conversions are done at most once and kept with the value.
+		virtual Span<double> asRealSpan() const { return Span<double>(); }
+		virtual Span<float> asFloatSpan() const { return Span<float>(); }
+		virtual Span<int> asIntegerSpan() const { return Span<int>(); }
+		virtual Span<bool> asBoolSpan() const { return Span<bool>(); }
+
+		virtual ArgType type() const = 0;
+		// Number of values, 1 for single values.
+		virtual size_t size() const { return 1; }
+
+		// False when the arguments could not be converted (only with PARSE_LAZY,
+		// otherwise parsing fails).
+		virtual bool valid() const { return true; }
+		virtual std::string error() const { return ""; }
+
+		operator bool() const { return type(); }
+
+		virtual bool read(int& inOutCurIndex,
+			char** inOutCurArgumentStr, int argc, char** inArgv) = 0;
+	};
+
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	namespace hidden
+	{
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		
+		template <typename T>
+		std::string numberToString(T Number)
+		{
+			std::ostringstream ss;
+			ss << Number;
+			return ss.str();
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Integer accessors of wider values saturate at the limits instead of
+		// wrapping, reals are truncated and NaN is 0.
+		template <typename T>
+		T realToInteger(double value)
+		{
+			if (value != value) return 0;
+			if (value <= (double)std::numeric_limits<T>::min()) return std::numeric_limits<T>::min();
+			if (value >= (double)std::numeric_limits<T>::max()) return std::numeric_limits<T>::max();
+			return (T)value;
+		}
+
+		inline int narrowToInt(double value) { return realToInteger<int>(value); }
+		inline int narrowToInt(int64_t value)
+		{
+			const int64_t low = std::numeric_limits<int>::min();
+			const int64_t high = std::numeric_limits<int>::max();
+			return (int)(value < low ? low : value > high ? high : value);
+		}
+		inline int narrowToInt(uint64_t value)
+		{
+			const uint64_t high = std::numeric_limits<int>::max();
+			return (int)(value > high ? high : value);
+		}
+
+		// One element converted by the accessors of Option and OptionView.
+		template <typename T, typename U>
+		T convertNumber(U value) { return (T)value; }
+
+		template <> inline int convertNumber<int>(double value) { return narrowToInt(value); }
+		template <> inline int convertNumber<int>(float value) { return narrowToInt((double)value); }
+		template <> inline int convertNumber<int>(int64_t value) { return narrowToInt(value); }
+		template <> inline int convertNumber<int>(uint64_t value) { return narrowToInt(value); }
+		template <> inline int64_t convertNumber<int64_t>(double value) { return realToInteger<int64_t>(value); }
+		template <> inline int64_t convertNumber<int64_t>(float value) { return realToInteger<int64_t>(value); }
+		template <> inline uint64_t convertNumber<uint64_t>(double value)
+		{
+			return (uint64_t)realToInteger<int64_t>(value);
+		}
+		template <> inline uint64_t convertNumber<uint64_t>(float value)
+		{
+			return (uint64_t)realToInteger<int64_t>(value);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Result of parseInteger / parseReal, same meaning as std::from_chars_result:
+		// ptr points past the parsed characters, ec is std::errc() on success,
+		// std::errc::invalid_argument if there is no number and
+		// std::errc::result_out_of_range if it does not fit into the type.
+		struct NumberResult
+		{
+			const char* ptr;
+			std::errc ec;
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		inline bool isDigit(char c)
+		{
+			return (unsigned)(c - '0') < 10;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Eight digits at once within a 64 bit word (little endian only, the
+		// scalar loops handle the rest). p must have 8 readable characters.
+		inline bool isEightDigits(const char* p)
+		{
+#if defined(SCLAP_NO_SIMD) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+			(void)p;
+			return false;
+#else
+			uint64_t word;
+			memcpy(&word, p, 8);
+			return (((word & 0xF0F0F0F0F0F0F0F0ull)
+				| (((word + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4))
+				== 0x3333333333333333ull);
+#endif
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Value of eight digits checked by isEightDigits.
+		inline uint32_t parseEightDigits(const char* p)
+		{
+			uint64_t word;
+			memcpy(&word, p, 8);
+			word = (word & 0x0F0F0F0F0F0F0F0Full) * 2561 >> 8;
+			word = (word & 0x00FF00FF00FF00FFull) * 6553601 >> 16;
+			return (uint32_t)((word & 0x0000FFFF0000FFFFull) * 42949672960001ull >> 32);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Locale independent decimal integer parsing with from_chars semantics,
+		// except that a leading '+' is accepted.
+		template <typename T>
+		NumberResult parseInteger(const char* first, const char* last, T& value)
+		{
+			const char* p = first;
+
+			bool negative = false;
+			if (p != last && (*p == '-' || *p == '+'))
+			{
+				negative = *p == '-';
+				++p;
+			}
+			if (negative && !std::numeric_limits<T>::is_signed)
+			{
+				NumberResult res = { first, std::errc::invalid_argument };
+				return res;
+			}
+
+			const char* digits = p;
+			uint64_t result = 0;
+
+			// fast path: up to 19 digits always fit into 64 bits
+			const char* fastLast = last - p > 19 ? p + 19 : last;
+			while (fastLast - p >= 8 && isEightDigits(p))
+			{
+				result = result * 100000000 + parseEightDigits(p);
+				p += 8;
+			}
+			while (p != fastLast && isDigit(*p))
+			{
+				result = result * 10 + (uint64_t)(*p - '0');
+				++p;
+			}
+
+			if (p == digits)
+			{
+				NumberResult res = { first, std::errc::invalid_argument };
+				return res;
+			}
+
+			bool overflow = false;
+			while (p != last && isDigit(*p))
+			{
+				const uint64_t digit = (uint64_t)(*p - '0');
+				if (result > (UINT64_MAX - digit) / 10) overflow = true;
+				else result = result * 10 + digit;
+				++p;
+			}
+
+			const uint64_t limit = negative
+				? (uint64_t)std::numeric_limits<T>::max() + 1
+				: (uint64_t)std::numeric_limits<T>::max();
+			if (overflow || result > limit)
+			{
+				NumberResult res = { p, std::errc::result_out_of_range };
+				return res;
+			}
+
+			// written so that the most negative value does not overflow
+			value = (negative && result) ? (T)(-(T)(result - 1) - 1) : (T)result;
+
+			NumberResult res = { p, std::errc() };
+			return res;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Case insensitive prefix match of a lower case word.
+		inline bool startsWithWord(const char* first, const char* last, const char* word)
+		{
+			for (; *word; ++word, ++first)
+			{
+				if (first == last || (*first | 0x20) != *word) return false;
+			}
+			return true;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Locale independent parsing of decimal reals (with optional exponent, inf and nan)
+		// with from_chars semantics, except that a leading '+' is accepted.
+		// Numbers with up to 19 significant digits and small exponents are converted
+		// exactly by a single multiplication or division (Clinger's fast path), others
+		// go through the classic "C" locale.
+		SCLAP_INLINE NumberResult parseReal(const char* first, const char* last, double& value);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool toInteger(const char* s, int& val);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool toDouble(const char* s, double& val);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool toInteger64(const char* s, int64_t& val);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool toUnsigned64(const char* s, uint64_t& val);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Unsigned 64 bit value of ARG_SIZE, the K, M and G suffixes (any case) multiply by 2^10, 2^20, 2^30.
+		SCLAP_INLINE bool toSize(const char* s, uint64_t& val);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Reals out of the range of float are errors, like out of the range of double.
+		inline bool toFloat(double real, float& val)
+		{
+			if (std::fabs(real) > std::numeric_limits<float>::max()
+				&& std::fabs(real) <= std::numeric_limits<double>::max())
+			{
+				return false;
+			}
+
+			val = (float)real;
+			return true;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		inline bool toNumber(const char* s, int& val) { return toInteger(s, val); }
+		inline bool toNumber(const char* s, double& val) { return toDouble(s, val); }
+
+		inline bool toNumber(const char* s, float& val)
+		{
+			double real;
+			return toDouble(s, real) && toFloat(real, val);
+		}
+
+		// Real of ARG_FLOAT_VEC before rounding, for the visitor.
+		inline bool toFloatRange(const char* s, double& val)
+		{
+			float rounded;
+			return toDouble(s, val) && toFloat(val, rounded);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool isSingleArgType(ArgType type);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Accessors of Option and OptionView which convert the values of a type, the others
+		// return 0 or an empty vector. asString() and asStringVector() convert every type.
+		enum Conversion
+		{
+			// asBool() is the value, for other types it is true when there are values
+			CONVERT_BOOL = 1 << 0,
+			// asInteger(), asInt64() and asUInt64()
+			CONVERT_INTEGER = 1 << 1,
+			CONVERT_REAL = 1 << 2,
+			// the vectors and their spans
+			CONVERT_BOOL_VECTOR = 1 << 3,
+			CONVERT_INTEGER_VECTOR = 1 << 4,
+			CONVERT_REAL_VECTOR = 1 << 5,
+			CONVERT_FLOAT_VECTOR = 1 << 6
+		};
+
+		inline uint32_t conversions(ArgType type)
+		{
+			switch (type)
+			{
+			case ARG_BOOL:
+			case ARG_BOOL_VEC: return CONVERT_BOOL | CONVERT_BOOL_VECTOR;
+			case ARG_INT:
+			case ARG_INT_VEC:
+				return CONVERT_BOOL | CONVERT_INTEGER | CONVERT_REAL
+					| CONVERT_BOOL_VECTOR | CONVERT_INTEGER_VECTOR | CONVERT_REAL_VECTOR;
+			case ARG_REAL: return CONVERT_INTEGER | CONVERT_REAL | CONVERT_REAL_VECTOR;
+			case ARG_INT64:
+			case ARG_UINT64:
+			case ARG_SIZE:
+				return CONVERT_BOOL | CONVERT_INTEGER | CONVERT_REAL | CONVERT_BOOL_VECTOR | CONVERT_REAL_VECTOR;
+			case ARG_REAL_VEC: return CONVERT_REAL | CONVERT_REAL_VECTOR;
+			case ARG_FLOAT_VEC: return CONVERT_REAL | CONVERT_REAL_VECTOR | CONVERT_FLOAT_VECTOR;
+			default: return 0;
+			}
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Converts the consecutive vector elements starting with *inOutCurArgumentStr
+		// (the argument at inOutCurIndex, possibly after its option name) straight
+		// into storage, in one pass with the conversion inlined. Elements end at the
+		// next option or an empty argument. On failure storage is empty and the
+		// position is not moved.
+		template <typename Storage>
+		bool readVector(Storage& storage, int& inOutCurIndex, char** inOutCurArgumentStr,
+			int argc, char** inArgv)
+		{
+			// locals, int elements could alias inOutCurIndex
+			char** const args = inArgv + inOutCurIndex;
+			const int available = argc - inOutCurIndex;
+
+			storage.clear();
+			int count = 0;
+			for (const char* arg = *inOutCurArgumentStr;
+				count < available && *arg != '-' && *arg != '\0';
+				arg = args[++count])
+			{
+				typename Storage::value_type value;
+				if (!toNumber(arg, value))
+				{
+					storage.clear();
+					return false;
+				}
+				storage.push_back(value);
+			}
+
+			inOutCurIndex += count;
+			*inOutCurArgumentStr = inArgv[inOutCurIndex];
+			return count > 0;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// True if the argument at curArgumentStr holds a whole packed vector value
+		// (see OptionDescriptor::listDelimiter).
+		inline bool isPackedList(const char* curArgumentStr, int curIndex, int argc,
+			char** argv, char delimiter)
+		{
+			if (delimiter == LIST_DELIMITER_NONE || curIndex >= argc) return false;
+
+			// attached with '=' if it does not start the argument
+			if (*curArgumentStr == '-' && curArgumentStr == argv[curIndex]) return false;
+
+			return strchr(curArgumentStr, delimiter) != NULL;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Next element of a packed list, inOutCur is NULL after the last one.
+		inline bool nextListElement(const char*& inOutCur, char delimiter, StringView& outElement)
+		{
+			if (!inOutCur) return false;
+
+			const char* end = inOutCur;
+			while (*end != delimiter && *end != '\0') ++end;
+
+			outElement = StringView(inOutCur, end - inOutCur);
+			inOutCur = *end ? end + 1 : NULL;
+			return true;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Conversions of packed list elements, empty elements are errors.
+		inline bool toElement(const StringView& s, int& val)
+		{
+			SCLAP_STAT(addStat(&ParseStats::intConversions, 1));
+			const NumberResult res = parseInteger(s.data(), s.data() + s.size(), val);
+			return res.ec == std::errc() && res.ptr == s.data() + s.size();
+		}
+
+		inline bool toElement(const StringView& s, double& val)
+		{
+			SCLAP_STAT(addStat(&ParseStats::realConversions, 1));
+			const NumberResult res = parseReal(s.data(), s.data() + s.size(), val);
+			return res.ec == std::errc() && res.ptr == s.data() + s.size();
+		}
+
+		inline bool toElement(const StringView& s, float& val)
+		{
+			double real;
+			return toElement(s, real) && toFloat(real, val);
+		}
+
+		inline bool toElement(const StringView& s, bool& val)
+		{
+			val = s == "True" || s == "true";
+			return val || s == "False" || s == "false";
+		}
+
+		inline bool toElement(const StringView& s, StringView& val)
+		{
+			val = s;
+			return !s.empty();
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Integer or range first-last (first <= last) of a packed ARG_INT_VEC list.
+		inline bool toRange(const StringView& s, int& outFirst, int& outLast)
+		{
+			SCLAP_STAT(addStat(&ParseStats::intConversions, 1));
+			const char* end = s.data() + s.size();
+			const NumberResult first = parseInteger(s.data(), end, outFirst);
+			if (first.ec != std::errc()) return false;
+			if (first.ptr == end)
+			{
+				outLast = outFirst;
+				return true;
+			}
+			if (*first.ptr != '-') return false;
+
+			const NumberResult last = parseInteger(first.ptr + 1, end, outLast);
+			return last.ec == std::errc() && last.ptr == end && outFirst <= outLast;
+		}
+
+		// Counts the values of a range of a packed list, false above LIST_RANGE_MAX.
+		inline bool countRange(size_t& inOutValues, int first, int last)
+		{
+			if (first == last) return true;
+
+			inOutValues += (size_t)((int64_t)last - first + 1);
+			return inOutValues <= LIST_RANGE_MAX;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Converts the packed list at *inOutCurArgumentStr into storage in one pass
+		// and moves past its argument. On failure storage is empty and the position
+		// is not moved.
+		template <typename Storage>
+		bool readPackedList(Storage& storage, char delimiter, int& inOutCurIndex,
+			char** inOutCurArgumentStr, char** inArgv)
+		{
+			storage.clear();
+
+			const char* cur = *inOutCurArgumentStr;
+			StringView element;
+			while (nextListElement(cur, delimiter, element))
+			{
+				typename Storage::value_type value;
+				if (!toElement(element, value))
+				{
+					storage.clear();
+					return false;
+				}
+				storage.push_back(value);
+			}
+
+			++inOutCurIndex;
+			*inOutCurArgumentStr = inArgv[inOutCurIndex];
+			return true;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool readInt(int& inOutCurIndex, char** inOutCurArgumentStr,
+			char** inArgv, int &outInteger);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool readDouble(int& inOutCurIndex, char** inOutCurArgumentStr,
+			char** inArgv, double &outDouble);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Does not copy, outString references the argument.
+		SCLAP_INLINE bool readString(int& inOutCurIndex, char** inOutCurArgumentStr,
+			char** inArgv, StringView &outString);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Same as readInt with another conversion.
+		template <typename T>
+		bool readWith(bool (*convert)(const char*, T&), int& inOutCurIndex,
+			char** inOutCurArgumentStr, char** inArgv, T& outValue)
+		{
+			if (!convert(*inOutCurArgumentStr, outValue)) return false;
+
+			++inOutCurIndex;
+			*inOutCurArgumentStr = inArgv[inOutCurIndex];
+			return true;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Order of the types of one argument, the highest one is read (see valueType).
+		inline int typeRank(ArgType type)
+		{
+			switch (type)
+			{
+			case ARG_STRING: case ARG_STRING_VEC: return 1;
+			case ARG_BOOL: case ARG_BOOL_VEC: return 2;
+			case ARG_INT: case ARG_INT_VEC: return 3;
+			case ARG_INT64: case ARG_FLOAT_VEC: return 4;
+			case ARG_UINT64: return 5;
+			case ARG_SIZE: return 6;
+			case ARG_REAL: case ARG_REAL_VEC: return 7;
+			default: return 8;
+			}
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Type of the elements of a vector type, for the first four the single type shifted by 4.
+		// There is no single float type, ARG_FLOAT_VEC stands for its elements.
+		inline ArgType elementType(ArgType vector)
+		{
+			return vector == ARG_FLOAT_VEC ? ARG_FLOAT_VEC : vector >> 4;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE ArgType getTypeToRead(ArgType single, ArgType vector);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		class OptionValueUnexisted : public OptionValue
+		{
+		public:
+			virtual bool asBool() const { return false; }
+
+			virtual ArgType type() const { return UNEXISTED; }
+			virtual size_t size() const { return 0; }
+
+			virtual bool read(int& inOutCurIndex, char** inOutCurArgumentStr,
+				int argc, char** inArgv) { return false; }
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Shared value of options which do not exist.
+		SCLAP_INLINE const OptionValueUnexisted& unexisted();
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		class OptionValueBool : public OptionValue
+		{
+		public:
+			virtual const std::string asString() const { return mValue ? "true" : "false"; };
+
+			virtual const std::vector<std::string> asStringVector() const
+			{
+				return std::vector<std::string>(1, asString());
+			}
+			virtual const std::vector<bool> asBoolVector() const
+			{
+				return std::vector<bool>(1, mValue);
+			}
+
+			virtual Span<bool> asBoolSpan() const { return Span<bool>(&mValue, 1); }
+
+			virtual ArgType type() const { return ARG_BOOL; }
+
+			virtual bool read(int& inOutCurIndex, char** inOutCurArgumentStr,
+				int argc, char** inArgv);
+
+			virtual bool asBool() const { return mValue; };
+
+		private:
+			bool mValue;
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		class OptionValueInt : public OptionValue
+		{
+		public:
+			virtual const std::string asString() const { return hidden::numberToString(mValue); };
+			virtual double asReal() const { return mValue; };
+			virtual int asInteger() const { return mValue; };
+			virtual bool asBool() const { return mValue; };
+
+			virtual const std::vector<std::string> asStringVector() const
+			{
+				return std::vector<std::string>(1, asString());
+			}
+			virtual const std::vector<double> asRealVector() const
+			{
+				return std::vector<double>(1, asReal());
+			}
+			virtual const std::vector<int> asIntegerVector() const
+			{
+				return std::vector<int>(1, asInteger());
+			}
+			virtual const std::vector<bool> asBoolVector() const
+			{
+				return std::vector<bool>(1, asBool());
+			}
+
+			virtual Span<double> asRealSpan() const { return Span<double>(&mReal, 1); }
+			virtual Span<int> asIntegerSpan() const { return Span<int>(&mValue, 1); }
+			virtual Span<bool> asBoolSpan() const { return Span<bool>(&mBool, 1); }
+
+			virtual ArgType type() const { return ARG_INT; }
+
+			virtual bool read(int& inOutCurIndex,
+				char** inOutCurArgumentStr, int argc, char** inArgv)
+			{
+				if (!readInt(inOutCurIndex, inOutCurArgumentStr, inArgv, mValue)) return false;
+
+				mReal = mValue;
+				mBool = mValue != 0;
+				return true;
+			}
+
+		private:
+			int mValue;
+			double mReal;
+			bool mBool;
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		class OptionValueReal : public OptionValue
+		{
+		public:
+			virtual const std::string asString() const { return hidden::numberToString(mValue); };
+			virtual double asReal() const { return mValue; };
+			virtual int asInteger() const { return convertNumber<int>(mValue); };
+			virtual int64_t asInt64() const { return convertNumber<int64_t>(mValue); }
+
+			virtual const std::vector<std::string> asStringVector() const
+			{
+				return std::vector<std::string>(1, asString());
+			}
+			virtual const std::vector<double> asRealVector() const
+			{
+				return std::vector<double>(1, asReal());
+			}
+
+			virtual Span<double> asRealSpan() const { return Span<double>(&mValue, 1); }
+
+			virtual ArgType type() const { return ARG_REAL; }
+
+			virtual bool read(int& inOutCurIndex,
+				char** inOutCurArgumentStr, int argc, char** inArgv)
+			{
+				return readDouble(inOutCurIndex, inOutCurArgumentStr, inArgv, mValue);
+			}
+
+		private:
+			double mValue;
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Values of the 64 bit types, T is int64_t or uint64_t.
+		template <typename T, ArgType Type, bool (*convert)(const char*, T&)>
+		class OptionValueInteger64 : public OptionValue
+		{
+		public:
+			virtual const std::string asString() const { return hidden::numberToString(mValue); };
+			virtual double asReal() const { return (double)mValue; };
+			virtual int asInteger() const { return convertNumber<int>(mValue); };
+			virtual int64_t asInt64() const { return convertNumber<int64_t>(mValue); }
+			virtual uint64_t asUInt64() const { return convertNumber<uint64_t>(mValue); }
+			virtual bool asBool() const { return mValue != 0; };
+
+			virtual const std::vector<std::string> asStringVector() const
+			{
+				return std::vector<std::string>(1, asString());
+			}
+			virtual const std::vector<double> asRealVector() const
+			{
+				return std::vector<double>(1, asReal());
+			}
+			virtual const std::vector<bool> asBoolVector() const
+			{
+				return std::vector<bool>(1, asBool());
+			}
+
+			virtual Span<double> asRealSpan() const { return Span<double>(&mReal, 1); }
+			virtual Span<bool> asBoolSpan() const { return Span<bool>(&mBool, 1); }
+
+			virtual ArgType type() const { return Type; }
+
+			virtual bool read(int& inOutCurIndex,
+				char** inOutCurArgumentStr, int argc, char** inArgv)
+			{
+				if (!readWith(convert, inOutCurIndex, inOutCurArgumentStr, inArgv, mValue)) return false;
+
+				mReal = (double)mValue;
+				mBool = mValue != 0;
+				return true;
+			}
+
+		private:
+			T mValue;
+			double mReal;
+			bool mBool;
+		};
+
+		typedef OptionValueInteger64<int64_t, ARG_INT64, toInteger64> OptionValueInt64;
+		typedef OptionValueInteger64<uint64_t, ARG_UINT64, toUnsigned64> OptionValueUInt64;
+		typedef OptionValueInteger64<uint64_t, ARG_SIZE, toSize> OptionValueSize;
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		class OptionValueString : public OptionValue
+		{
+		public:
+			// Without copy the value references argv.
+			OptionValueString(Arena* arena, bool copy)
+				: mValue(), mCopy(ArenaAllocator<char>(arena)), mShouldCopy(copy)
+			{}
+
+			virtual const std::string asString() const { return mValue.str(); };
+			virtual StringView asStringView() const { return mValue; }
+			virtual Span<StringView> asStringViews() const { return Span<StringView>(&mValue, 1); }
+
+			virtual const std::vector<std::string> asStringVector() const
+			{
+				return std::vector<std::string>(1, asString());
+			}
+
+			virtual ArgType type() const { return ARG_STRING; }
+
+			virtual bool read(int& inOutCurIndex,
+				char** inOutCurArgumentStr, int argc, char** inArgv)
+			{
+				if (inOutCurIndex >= argc)
+				{
+					return false;
+				}
+				else if (!readString(inOutCurIndex, inOutCurArgumentStr, inArgv, mValue))
+				{
+					return false;
+				}
+
+				if (mShouldCopy)
+				{
+					mCopy.assign(mValue.data(), mValue.size());
+					mValue = StringView(mCopy.data(), mCopy.size());
+				}
+				return true;
+			}
+
+		private:
+			StringView mValue;
+			String mCopy;
+			const bool mShouldCopy;
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		class OptionValueBoolVector : public OptionValue
+		{
+		public:
+			OptionValueBoolVector(Arena* arena, char delimiter)
+				: mValue(arena), mDelimiter(delimiter)
+			{}
+
+			virtual const std::string asString() const { return mValue[0] ? "true" : "false"; }
+			virtual const std::vector<std::string> asStringVector() const;
+			virtual bool asBool() const { return mValue[0]; }
+			virtual const std::vector<bool> asBoolVector() const
+			{
+				return std::vector<bool>(mValue.data(), mValue.data() + mValue.size());
+			}
+			virtual Span<bool> asBoolSpan() const { return Span<bool>(mValue.data(), mValue.size()); }
+  
+			virtual ArgType type() const { return ARG_BOOL_VEC; }
+			virtual size_t size() const { return mValue.size(); }
+
+			virtual bool read(int& inOutCurIndex,
+				char** inOutCurArgumentStr, int argc, char** inArgv);
+
+		private:
+			Buffer<bool> mValue;
+			const char mDelimiter;
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		class OptionValueIntVector : public OptionValue
+		{
+		public:
+			OptionValueIntVector(Arena* arena, char delimiter)
+				: mValue(ArenaAllocator<int>(arena)), mRanges(arena), mDelimiter(delimiter),
+				mRealCache(arena), mBoolCache(arena)
+			{}
+
+			virtual const std::string asString() const { return hidden::numberToString(front()); };
+			virtual double asReal() const { return front(); };
+			virtual int asInteger() const { return front(); };
+			virtual bool asBool() const { return front() != 0; };
+
+			virtual const std::vector<std::string> asStringVector() const;
+			virtual const std::vector<double> asRealVector() const
+			{
+				return std::vector<double>(values().begin(), values().end());
+			}
+			virtual const std::vector<int> asIntegerVector() const
+			{ 
+				return std::vector<int>(values().begin(), values().end());
+			}
+			virtual const std::vector<bool> asBoolVector() const
+			{
+				return std::vector<bool>(values().begin(), values().end());
+			}
+
+			virtual Span<double> asRealSpan() const;
+			virtual Span<int> asIntegerSpan() const { return Span<int>(values().data(), values().size()); }
+			virtual Span<bool> asBoolSpan() const;
+
+			virtual ArgType type() const { return ARG_INT_VEC; }
+			virtual size_t size() const;
+
+			virtual bool read(int& inOutCurIndex,
+				char** inOutCurArgumentStr, int argc, char** inArgv);
+
+		private:
+			// Range of a packed list, inserted before mValue[position].
+			struct Range
+			{
+				size_t position;
+				int first;
+				int last;
+			};
+
+			typedef std::vector<int, ArenaAllocator<int> > Values;
+
+			// ranges are expanded into mValue on first access
+			mutable Values mValue;
+			mutable Buffer<Range> mRanges;
+			const char mDelimiter;
+
+			// converted on first access
+			mutable Buffer<double> mRealCache;
+			mutable Buffer<bool> mBoolCache;
+
+			const Values& values() const;
+			// first value, without expanding the ranges
+			int front() const
+			{
+				return !mRanges.empty() && mRanges[0].position == 0 ? mRanges[0].first : mValue[0];
+			}
+			bool readPacked(const char* list);
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		class OptionValueRealVector : public OptionValue
+		{
+		public:
+			OptionValueRealVector(Arena* arena, char delimiter)
+				: mValue(ArenaAllocator<double>(arena)), mDelimiter(delimiter)
+			{}
+
+			virtual const std::string asString() const { return hidden::numberToString(mValue[0]); };
+			virtual double asReal() const { return mValue[0]; };
+
+			virtual const std::vector<std::string> asStringVector() const;
+			virtual const std::vector<double> asRealVector() const
+			{
+				return std::vector<double>(mValue.begin(), mValue.end());
+			}
+
+			virtual Span<double> asRealSpan() const { return Span<double>(mValue.data(), mValue.size()); }
+
+			virtual ArgType type() const { return ARG_REAL_VEC; }
+			virtual size_t size() const { return mValue.size(); }
+
+			virtual bool read(int& inOutCurIndex,
+				char** inOutCurArgumentStr, int argc, char** inArgv);
+
+		private:
+			std::vector<double, ArenaAllocator<double> > mValue;
+			const char mDelimiter;
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Half the memory of OptionValueRealVector, converted through double.
+		class OptionValueFloatVector : public OptionValue
+		{
+		public:
+			OptionValueFloatVector(Arena* arena, char delimiter)
+				: mValue(ArenaAllocator<float>(arena)), mDelimiter(delimiter), mRealCache(arena)
+			{}
+
+			virtual const std::string asString() const { return hidden::numberToString(mValue[0]); };
+			virtual double asReal() const { return mValue[0]; };
+
+			virtual const std::vector<std::string> asStringVector() const;
+			virtual const std::vector<double> asRealVector() const
+			{
+				return std::vector<double>(mValue.begin(), mValue.end());
+			}
+			virtual const std::vector<float> asFloatVector() const
+			{
+				return std::vector<float>(mValue.begin(), mValue.end());
+			}
+
+			virtual Span<double> asRealSpan() const;
+			virtual Span<float> asFloatSpan() const { return Span<float>(mValue.data(), mValue.size()); }
+
+			virtual ArgType type() const { return ARG_FLOAT_VEC; }
+			virtual size_t size() const { return mValue.size(); }
+
+			virtual bool read(int& inOutCurIndex,
+				char** inOutCurArgumentStr, int argc, char** inArgv);
+
+		private:
+			std::vector<float, ArenaAllocator<float> > mValue;
+			const char mDelimiter;
+
+			// converted on first access
+			mutable Buffer<double> mRealCache;
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		class OptionValueStringVector : public OptionValue
+		{
+		public:
+			// Without copy the values reference argv, with copy they share one buffer.
+			OptionValueStringVector(Arena* arena, bool copy, char delimiter)
+				: mValue(ArenaAllocator<StringView>(arena)), mCopy(ArenaAllocator<char>(arena)),
+				mShouldCopy(copy), mDelimiter(delimiter)
+			{}
+
+			virtual const std::string asString() const { return mValue[0].str(); };
+			virtual const std::vector<std::string> asStringVector() const;
+			virtual StringView asStringView() const { return mValue[0]; }
+			virtual Span<StringView> asStringViews() const
+			{
+				return Span<StringView>(mValue.data(), mValue.size());
+			}
+
+			virtual ArgType type() const { return ARG_STRING_VEC; }
+			virtual size_t size() const { return mValue.size(); }
+
+			virtual bool read(int& inOutCurIndex,
+				char** inOutCurArgumentStr, int argc, char** inArgv);
+
+		private:
+			std::vector<StringView, ArenaAllocator<StringView> > mValue;
+			String mCopy;
+			const bool mShouldCopy;
+			const char mDelimiter;
+
+			void copyValues();
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Descriptors of the options of one argument (--long or -abc) in the order
+		// of appearance. Short names are unique, so there are at most 256.
+		struct ArgumentOptions
+		{
+			const DescriptorView* descriptors[256];
+			size_t size;
+			// short names already seen, as bits
+			uint64_t shortNames[4];
+
+			ArgumentOptions() : size(0) { clear(); }
+
+			void clear()
+			{
+				size = 0;
+				shortNames[0] = shortNames[1] = shortNames[2] = shortNames[3] = 0;
+			}
+
+			// False if the short name was already added.
+			bool addShort(char opt, const DescriptorView* desc)
+			{
+				const unsigned char bit = (unsigned char)opt;
+				const uint64_t mask = (uint64_t)1 << (bit & 63);
+				if (shortNames[bit >> 6] & mask) return false;
+
+				shortNames[bit >> 6] |= mask;
+				descriptors[size++] = desc;
+				return true;
+			}
+
+			void addLong(const DescriptorView* desc)
+			{
+				descriptors[size++] = desc;
+			}
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// extract long option (--long --> { "long" })
+		// or set (or single) of short options (-short --> { "s", "h", "o", "r", "t" })
+		// and resolve their descriptors, without allocating.
+		SCLAP_INLINE bool readOptionNames(const DescriptorSet& descriptors, int& inOutCurIndex,
+			char** inOutCurArgumentStr, char** inArgv, ArgumentOptions& outOptions, Error& outError);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Type of the value shared by all options of one argument (e.g. -abc), UNEXISTED
+		// when a 64 bit option shares it with a vector option.
+		SCLAP_INLINE ArgType valueType(const ArgumentOptions& options);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// List delimiter of the value of one argument, the first one set.
+		SCLAP_INLINE char listDelimiter(const ArgumentOptions& options);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// NULL for unknown types. delimiter is the list delimiter of vector values.
+		SCLAP_INLINE OptionValue* createValue(ArgType type, Arena* arena, bool copyStrings, char delimiter);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		/*--------------------------------------------------------------------------------------------*/
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Value of PARSE_LAZY. read() only finds the arguments which belong to the value,
+		// the first access reads them into a value of the type.
+		class OptionValueLazy : public OptionValue
+		{
+		public:
+			OptionValueLazy(ArgType type, char delimiter, Arena* arena, bool copyStrings)
+				: mType(type), mDelimiter(delimiter), mArena(arena), mCopyStrings(copyStrings),
+				mArgv(NULL), mFirstIndex(0), mEndIndex(0), mFirstArgumentStr(NULL),
+				mValue(NULL), mConverted(false)
+			{}
+
+			virtual ~OptionValueLazy()
+			{
+				if (mValue) destroy(mArena, mValue);
+			}
+
+			virtual const std::string asString() const { return value().asString(); }
+			virtual double asReal() const { return value().asReal(); }
+			virtual int asInteger() const { return value().asInteger(); }
+			virtual bool asBool() const { return value().asBool(); }
+			virtual int64_t asInt64() const { return value().asInt64(); }
+			virtual uint64_t asUInt64() const { return value().asUInt64(); }
+
+			virtual const std::vector<std::string> asStringVector() const { return value().asStringVector(); }
+			virtual const std::vector<double> asRealVector() const { return value().asRealVector(); }
+			virtual const std::vector<float> asFloatVector() const { return value().asFloatVector(); }
+			virtual const std::vector<int> asIntegerVector() const { return value().asIntegerVector(); }
+			virtual const std::vector<bool> asBoolVector() const { return value().asBoolVector(); }
+
+			virtual StringView asStringView() const { return value().asStringView(); }
+			virtual Span<StringView> asStringViews() const { return value().asStringViews(); }
+			virtual Span<double> asRealSpan() const { return value().asRealSpan(); }
+			virtual Span<float> asFloatSpan() const { return value().asFloatSpan(); }
+			virtual Span<int> asIntegerSpan() const { return value().asIntegerSpan(); }
+			virtual Span<bool> asBoolSpan() const { return value().asBoolSpan(); }
+
+			virtual ArgType type() const { return mType; }
+			virtual size_t size() const { return value().size(); }
+
+			virtual bool valid() const
+			{
+				value();
+				return mValue != NULL;
+			}
+
+			virtual std::string error() const
+			{
+				if (valid()) return "";
+				return makeError(ERROR_READ_ARGUMENT, mFirstArgumentStr, strlen(mFirstArgumentStr),
+					mFirstIndex, mFirstArgumentStr - mArgv[mFirstIndex]).str();
+			}
+
+			virtual bool read(int& inOutCurIndex, char** inOutCurArgumentStr,
+				int argc, char** inArgv);
+
+		private:
+			const ArgType mType;
+			const char mDelimiter;
+			Arena* const mArena;
+			const bool mCopyStrings;
+
+			// arguments [mFirstIndex, mEndIndex), the first from mFirstArgumentStr
+			char** mArgv;
+			int mFirstIndex;
+			int mEndIndex;
+			char* mFirstArgumentStr;
+
+			mutable OptionValue* mValue;
+			mutable bool mConverted;
+
+			const OptionValue& value() const;
+		};
+
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Base class for options with different type of arguments defined in private namespace.
+	// Provides basic functionality and interface.
+	class Option
+	{
+	public:
+		// longName is not copied, it must outlive the option.
+		Option(const char shortName, const char* longName, const OptionValue* value)
+			: mShortName(shortName), mLongName(longName), mValue(value)
+		{
+			if (!value)
+			{
+				mValue = &hidden::unexisted();
+			}
+		}
+
+		virtual ~Option() {}
+
+		const char shortName() const
+		{
+			return mShortName;
+		}
+
+		const std::string longName() const
+		{
+			return mLongName;
+		}
+
+		// Does not allocate unlike longName().
+		StringView longNameView() const
+		{
+			return StringView(mLongName);
+		}
+
+		ArgType type() const { return mValue->type(); }
+		// Number of values, 1 for single values and 0 for missing options.
+		size_t size() const { return mValue->size(); }
+
+		// Converted as listed by hidden::conversions, the same way as OptionView.
+		bool asBool() const { return converts(hidden::CONVERT_BOOL) ? mValue->asBool() : size() != 0; }
+		const std::vector<bool> asBoolVector() const
+		{
+			return converts(hidden::CONVERT_BOOL_VECTOR) ? mValue->asBoolVector() : std::vector<bool>();
+		}
+		int asInteger() const { return converts(hidden::CONVERT_INTEGER) ? mValue->asInteger() : 0; }
+		const std::vector<int> asIntegerVector() const
+		{
+			return converts(hidden::CONVERT_INTEGER_VECTOR) ? mValue->asIntegerVector() : std::vector<int>();
+		}
+		int64_t asInt64() const { return converts(hidden::CONVERT_INTEGER) ? mValue->asInt64() : 0; }
+		uint64_t asUInt64() const { return converts(hidden::CONVERT_INTEGER) ? mValue->asUInt64() : 0; }
+		double asDouble() const { return converts(hidden::CONVERT_REAL) ? mValue->asReal() : 0; }
+		const std::vector<double> asRealVector() const
+		{
+			return converts(hidden::CONVERT_REAL_VECTOR) ? mValue->asRealVector() : std::vector<double>();
+		}
+		const std::vector<float> asFloatVector() const
+		{
+			return converts(hidden::CONVERT_FLOAT_VECTOR) ? mValue->asFloatVector() : std::vector<float>();
+		}
+		const std::string asString() const { return mValue->asString(); }
+		const std::vector<std::string> asStringVector() const { return mValue->asStringVector(); }
+		StringView asStringView() const { return mValue->asStringView(); }
+		Span<StringView> asStringViews() const { return mValue->asStringViews(); }
+		Span<bool> asBoolSpan() const
+		{
+			return converts(hidden::CONVERT_BOOL_VECTOR) ? mValue->asBoolSpan() : Span<bool>();
+		}
+		Span<int> asIntegerSpan() const
+		{
+			return converts(hidden::CONVERT_INTEGER_VECTOR) ? mValue->asIntegerSpan() : Span<int>();
+		}
+		Span<double> asRealSpan() const
+		{
+			return converts(hidden::CONVERT_REAL_VECTOR) ? mValue->asRealSpan() : Span<double>();
+		}
+		Span<float> asFloatSpan() const
+		{
+			return converts(hidden::CONVERT_FLOAT_VECTOR) ? mValue->asFloatSpan() : Span<float>();
+		}
+		operator bool() const { return asBool(); }
+
+		// Conversion errors of PARSE_LAZY.
+		bool valid() const { return mValue->valid(); }
+		std::string error() const { return mValue->error(); }
+
+	private:
+		const char mShortName;
+		const char* const mLongName;
+		const OptionValue* mValue;
+
+		bool converts(uint32_t conversion) const { return (hidden::conversions(type()) & conversion) != 0; }
+	};
+
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	namespace hidden
+	{
+		struct OptionLongNameEqual
+		{
+			Option* const* options;
+
+			bool operator()(int index, const char* name, size_t size) const
+			{
+				const StringView longName = options[index]->longNameView();
+				return longName.size() == size && !memcmp(longName.data(), name, size);
+			}
+		};
+
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Thread safety: descriptor sets (OptionDescriptors, CompiledDescriptors, Schema)
+	// are only read by parsing, so any number of threads can parse against one set
+	// as long as nothing is added to it meanwhile. An Options object must be used by
+	// one thread at a time, values may convert and cache on access (PARSE_LAZY, spans).
+	// An Arena must not be shared between threads.
+	class Options
+	{
+	public:
+		// Parses against a private compiled copy of the descriptors.
+		// With an arena, all parse results are allocated from it (see Arena).
+		// flags is a combination of PARSE_* flags.
+		Options(const OptionDescriptors& descriptors, int argc, char** argv,
+			Arena* arena = NULL, uint32_t flags = PARSE_DEFAULT)
+			: Options(descriptors.compile(), argc, argv, arena, flags)
+		{}
+
+		// Shares the compiled descriptors with other Options, nothing is copied.
+		Options(const std::shared_ptr<const CompiledDescriptors>& descriptors, int argc, char** argv,
+			Arena* arena = NULL, uint32_t flags = PARSE_DEFAULT)
+			: Options(descriptors, *descriptors, argc, argv, arena, flags)
+		{}
+
+		// Parses against the descriptors without copying them (e.g. a Schema),
+		// they must outlive Options.
+		Options(const DescriptorSet& descriptors, int argc, char** argv,
+			Arena* arena = NULL, uint32_t flags = PARSE_DEFAULT)
+			: Options(std::shared_ptr<const DescriptorSet>(), descriptors, argc, argv, arena, flags)
+		{}
+
+		// Does not free anything when the results live in an arena.
+		~Options()
+		{
+			for (size_t i = 0; i < mOptions.size(); ++i)
+			{
+				hidden::destroy(mArena, mOptions[i]);
+			}
+			for (size_t i = 0; i < mOptionValues.size(); ++i)
+			{
+				hidden::destroy(mArena, mOptionValues[i]);
+			}
+			for (size_t i = 0; i < mFiles.size(); ++i)
+			{
+				mFiles[i]->close();
+				hidden::destroy(mArena, mFiles[i]);
+			}
+		}
+
+		bool valid() const { return mOk; }
+		std::string error() const { return hidden::formatErrors(mErrors); }
+		const std::vector<Error>& errors() const { return mErrors; }
+
+		// The first occurrence of an option, lookup does not depend on the number of options.
+		// Options not given in argv are taken from their environment variables.
+		const Option& operator[](const std::string& option) const;
+		const Option& operator[](const char* option) const;
+		const Option& operator[](char option) const;
+
+		// Adds the options of a config file under the options given so far (argv and
+		// the environment), only their first occurrence is kept. Every line holds one
+		// option by long name, "name = value", empty lines and lines starting with #
+		// are skipped. Values of vector options without a list delimiter are split
+		// like response files, other values are the rest of the line. The file is
+		// mapped and read in place for the lifetime of Options, with PARSE_ZERO_COPY
+		// string values reference the mapping. Stops at the first invalid line.
+		bool readConfigFile(const char* path);
+
+		// Flat copy of all options and values for OptionsView, e.g. to hand the parsed
+		// command line to child processes. Only readable by the same build of sclap
+		// on the same architecture.
+		std::vector<char> serialize() const;
+		// Writes serialize() to the file (also /proc/self/fd/N of a memfd).
+		bool serialize(const char* path) const;
+
+#ifdef SCLAP_STATS
+		const ParseStats& stats() const { return mStats; }
+#endif
+
+	private:
+		// The public constructors delegate here, owner is empty when the descriptors
+		// are only referenced.
+		Options(const std::shared_ptr<const DescriptorSet>& owner, const DescriptorSet& descriptors,
+			int argc, char** argv, Arena* arena, uint32_t flags)
+			: mOwnDescriptors(owner), mDescriptors(descriptors),
+			mArena(arena), mFlags(flags),
+			mOptions(hidden::ArenaAllocator<Option*>(arena)),
+			mOptionValues(hidden::ArenaAllocator<OptionValue*>(arena)),
+			mLongIndex(hidden::ArenaAllocator<int>(arena)),
+			mArguments(arena), mFiles(arena), mOk(false)
+		{
+			if (mDescriptors.valid())
+			{
+				mOk = true;
+				parse(argc, argv);
+			}
+			index();
+			if (mOk) readEnvironment();
+		}
+
+		// result of lookups of options which do not exist
+		static const Option& none();
+
+		// owner of mDescriptors, empty when they are only referenced
+		std::shared_ptr<const DescriptorSet> mOwnDescriptors;
+		const DescriptorSet& mDescriptors;
+
+		Arena* mArena;
+		const uint32_t mFlags;
+
+		std::vector<Option*, hidden::ArenaAllocator<Option*> > mOptions;
+		std::vector<OptionValue*, hidden::ArenaAllocator<OptionValue*> > mOptionValues;
+
+		// positions in mOptions by short and long name
+		int mShortIndex[256];
+		hidden::BasicNameIndex<hidden::ArenaAllocator<int> > mLongIndex;
+
+		// argv with response files expanded (PARSE_RESPONSE_FILES)
+		hidden::Buffer<char*> mArguments;
+		// response and config files
+		hidden::Buffer<hidden::MappedFile*> mFiles;
+
+		std::vector<Error> mErrors;
+		bool mOk;
+
+#ifdef SCLAP_STATS
+		ParseStats mStats = ParseStats();
+#endif
+
+		void parse(int argc, char** argv);
+		bool expandResponseFiles(int argc, char** argv);
+		void readEnvironment();
+		bool readConfigLine(char* line, char* end, int number, hidden::Buffer<char*>& arguments);
+		void index();
+		void index(size_t option);
+		const Option& find(const char* option, size_t size) const;
+	};
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	namespace hidden
+	{
+		// Layout of serialized Options: header, long name slots, option records, then the
+		// names and elements. Offsets are from the start of the data, every table and
+		// element array is aligned to 8 bytes.
+		struct SerializedHeader
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t options;
+			// open addressing table of the long names, a power of two
+			uint32_t slots;
+			uint32_t reserved;
+			uint64_t size;
+			// first option of every short name, NameIndex::NONE without one
+			int32_t shortIndex[256];
+		};
+
+		struct SerializedSlot
+		{
+			uint32_t hash;
+			int32_t option;
+		};
+
+		// Scalars are stored as one element. Elements of ARG_STRING and ARG_STRING_VEC
+		// are SerializedString, the others their type in Option (bool as one byte).
+		struct SerializedOption
+		{
+			uint64_t name;
+			uint64_t nameSize;
+			uint64_t elements;
+			uint64_t count;
+			ArgType type;
+			char shortName;
+			// 0 without elements for PARSE_LAZY values which could not be converted, otherwise 1
+			uint8_t valid;
+		};
+
+		// Followed by '\0'.
+		struct SerializedString
+		{
+			uint64_t offset;
+			uint64_t size;
+		};
+
+		const char SERIALIZED_MAGIC[8] = { 's', 'c', 'l', 'a', 'p', 'b', 'i', 'n' };
+		const uint32_t SERIALIZED_VERSION = 2;
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Appends the bytes at the next multiple of 8 and returns their offset.
+		SCLAP_INLINE uint64_t appendAligned(std::vector<char>& data, const void* bytes, size_t size);
+
+		// Size of one serialized element of the type, 0 for unknown types.
+		SCLAP_INLINE size_t serializedElementSize(ArgType type);
+
+		// The name, the elements and the strings of the option lie within size bytes of data.
+		SCLAP_INLINE bool validSerializedOption(const char* data, uint64_t size, const SerializedOption& option);
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Option of an OptionsView with the accessors of Option, converted the same way
+	// through hidden::conversions and hidden::convertNumber. Spans point into the
+	// serialized data and are empty for other element types than the stored one.
+	// asStringViews() is replaced by size() and asStringView(i), as the data holds
+	// offsets instead of pointers.
+	class OptionView
+	{
+	public:
+		OptionView() : mData(NULL), mOption(NULL) {}
+		OptionView(const char* data, const hidden::SerializedOption* option)
+			: mData(data), mOption(option)
+		{}
+
+		char shortName() const { return mOption ? mOption->shortName : OPT_SHORT_NONE; }
+		const std::string longName() const { return std::string(longNameView().data(), longNameView().size()); }
+		StringView longNameView() const
+		{
+			return mOption ? StringView(mData + mOption->name, (size_t)mOption->nameSize) : StringView();
+		}
+
+		ArgType type() const { return mOption ? mOption->type : UNEXISTED; }
+		// Number of elements, 1 for single values.
+		size_t size() const { return mOption ? (size_t)mOption->count : 0; }
+		// False like Option::valid() when PARSE_LAZY could not convert the arguments,
+		// the option has no elements then.
+		bool valid() const { return !mOption || mOption->valid; }
+
+		bool asBool() const { return converts(hidden::CONVERT_BOOL) ? number<bool>() : size() != 0; }
+		const std::vector<bool> asBoolVector() const { return vector<bool>(hidden::CONVERT_BOOL_VECTOR); }
+		int asInteger() const { return converts(hidden::CONVERT_INTEGER) ? number<int>() : 0; }
+		const std::vector<int> asIntegerVector() const { return vector<int>(hidden::CONVERT_INTEGER_VECTOR); }
+		int64_t asInt64() const { return converts(hidden::CONVERT_INTEGER) ? number<int64_t>() : 0; }
+		uint64_t asUInt64() const { return converts(hidden::CONVERT_INTEGER) ? number<uint64_t>() : 0; }
+		double asDouble() const { return converts(hidden::CONVERT_REAL) ? number<double>() : 0; }
+		const std::vector<double> asRealVector() const { return vector<double>(hidden::CONVERT_REAL_VECTOR); }
+		const std::vector<float> asFloatVector() const { return vector<float>(hidden::CONVERT_FLOAT_VECTOR); }
+		const std::string asString() const { return size() ? elementString(0) : std::string(); }
+		const std::vector<std::string> asStringVector() const;
+		StringView asStringView(size_t i = 0) const;
+		Span<bool> asBoolSpan() const { return span<bool>(ARG_BOOL, ARG_BOOL_VEC); }
+		Span<int> asIntegerSpan() const { return span<int>(ARG_INT, ARG_INT_VEC); }
+		Span<double> asRealSpan() const { return span<double>(ARG_REAL, ARG_REAL_VEC); }
+		Span<float> asFloatSpan() const { return span<float>(ARG_FLOAT_VEC, ARG_FLOAT_VEC); }
+		operator bool() const { return asBool(); }
+
+	private:
+		const char* mData;
+		const hidden::SerializedOption* mOption;
+
+		bool isString() const { return type() == ARG_STRING || type() == ARG_STRING_VEC; }
+		bool converts(uint32_t conversion) const { return (hidden::conversions(type()) & conversion) != 0; }
+		std::string elementString(size_t i) const;
+
+		template <typename T>
+		const T* elements() const { return (const T*)(mData + mOption->elements); }
+
+		// Element i converted to T, 0 for strings and missing elements.
+		template <typename T>
+		T number(size_t i = 0) const;
+
+		template <typename T>
+		std::vector<T> vector(uint32_t conversion) const
+		{
+			std::vector<T> ret;
+			if (!converts(conversion)) return ret;
+
+			ret.reserve(size());
+			for (size_t i = 0; i < size(); ++i)
+			{
+				ret.push_back(number<T>(i));
+			}
+			return ret;
+		}
+
+		template <typename T>
+		Span<T> span(ArgType single, ArgType vector) const
+		{
+			return type() == single || type() == vector ? Span<T>(elements<T>(), size()) : Span<T>();
+		}
+	};
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	template <typename T>
+	T OptionView::number(size_t i) const
+	{
+		if (i >= size()) return T();
+
+		switch (type())
+		{
+		case ARG_BOOL:
+		case ARG_BOOL_VEC: return hidden::convertNumber<T>(elements<bool>()[i]);
+		case ARG_INT:
+		case ARG_INT_VEC: return hidden::convertNumber<T>(elements<int>()[i]);
+		case ARG_REAL:
+		case ARG_REAL_VEC: return hidden::convertNumber<T>(elements<double>()[i]);
+		case ARG_FLOAT_VEC: return hidden::convertNumber<T>(elements<float>()[i]);
+		case ARG_INT64: return hidden::convertNumber<T>(elements<int64_t>()[i]);
+		case ARG_UINT64:
+		case ARG_SIZE: return hidden::convertNumber<T>(elements<uint64_t>()[i]);
+		default: return T();
+		}
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Serialized Options read in place, see Options::serialize. Opening checks the indices
+	// and offsets of the tables and records against the data once, a corrupt or truncated
+	// image is rejected. Nothing is parsed or copied, lookups use the serialized tables:
+	//
+	//     options.serialize("/proc/self/fd/3");  // in the parent, fd 3 from memfd_create
+	//     sclap::OptionsView view;
+	//     view.open("/proc/self/fd/3");          // in the child
+	//     int port = view["port"].asInteger();
+	class OptionsView
+	{
+	public:
+		OptionsView() : mData(NULL), mFile() {}
+		OptionsView(const OptionsView&) = delete;
+		OptionsView& operator=(const OptionsView&) = delete;
+
+		// data must be aligned to 8 bytes and outlive the view.
+		bool open(const void* data, size_t size);
+		// Maps the file for the lifetime of the view.
+		bool open(const char* path);
+
+		bool valid() const { return mData != NULL; }
+		size_t size() const { return valid() ? header().options : 0; }
+
+		// The first occurrence of an option, like Options.
+		OptionView operator[](const std::string& option) const { return find(option.data(), option.size()); }
+		OptionView operator[](const char* option) const { return find(option, strlen(option)); }
+		OptionView operator[](char option) const;
+
+	private:
+		const char* mData;
+		hidden::MappedFile mFile;
+
+		const hidden::SerializedHeader& header() const { return *(const hidden::SerializedHeader*)mData; }
+		const hidden::SerializedSlot* slots() const
+		{
+			return (const hidden::SerializedSlot*)(mData + sizeof(hidden::SerializedHeader));
+		}
+		const hidden::SerializedOption* options() const
+		{
+			return (const hidden::SerializedOption*)(slots() + header().slots);
+		}
+
+		OptionView find(const char* option, size_t size) const;
+	};
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Receives options and values from visitOptions. Return false to stop parsing.
+	class OptionVisitor
+	{
+	public:
+		virtual ~OptionVisitor() {}
+
+		// Called for every option of an argument before its values.
+		virtual bool onOption(const DescriptorView&) { return true; }
+
+		virtual bool onBool(const DescriptorView&, bool) { return true; }
+		virtual bool onInteger(const DescriptorView&, int) { return true; }
+		// ARG_INT64, and ARG_UINT64 and ARG_SIZE
+		virtual bool onInteger64(const DescriptorView&, int64_t) { return true; }
+		virtual bool onUnsigned64(const DescriptorView&, uint64_t) { return true; }
+		// also the elements of ARG_FLOAT_VEC, before rounding to float
+		virtual bool onReal(const DescriptorView&, double) { return true; }
+		// value references argv
+		virtual bool onString(const DescriptorView&, StringView) { return true; }
+	};
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	namespace hidden
+	{
+		inline bool visitValue(OptionVisitor& visitor, const DescriptorView& desc, bool value)
+		{
+			return visitor.onBool(desc, value);
+		}
+
+		inline bool visitValue(OptionVisitor& visitor, const DescriptorView& desc, int value)
+		{
+			return visitor.onInteger(desc, value);
+		}
+
+		inline bool visitValue(OptionVisitor& visitor, const DescriptorView& desc, int64_t value)
+		{
+			return visitor.onInteger64(desc, value);
+		}
+
+		inline bool visitValue(OptionVisitor& visitor, const DescriptorView& desc, uint64_t value)
+		{
+			return visitor.onUnsigned64(desc, value);
+		}
+
+		inline bool visitValue(OptionVisitor& visitor, const DescriptorView& desc, double value)
+		{
+			return visitor.onReal(desc, value);
+		}
+
+		inline bool visitValue(OptionVisitor& visitor, const DescriptorView& desc, StringView value)
+		{
+			return visitor.onString(desc, value);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Options of the current argument and whether the visitor stopped parsing.
+		struct VisitContext
+		{
+			const ArgumentOptions& options;
+			OptionVisitor& visitor;
+			bool stopped;
+
+			bool visitOptions()
+			{
+				for (size_t i = 0; i < options.size; ++i)
+				{
+					if (!visitor.onOption(*options.descriptors[i]))
+					{
+						stopped = true;
+						return false;
+					}
+				}
+				return true;
+			}
+
+			template <typename T>
+			bool visit(T value)
+			{
+				for (size_t i = 0; i < options.size; ++i)
+				{
+					if (!visitValue(visitor, *options.descriptors[i], value))
+					{
+						stopped = true;
+						return false;
+					}
+				}
+				return true;
+			}
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Reads one value of a single type, as an element of a vector for ARG_BOOL.
+		SCLAP_INLINE bool visitElement(VisitContext& context, ArgType type, int& inOutCurIndex,
+			char** inOutCurArgumentStr, char** inArgv);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Reports each element of a packed list of a single type, ranges value by value.
+		SCLAP_INLINE bool visitPackedList(VisitContext& context, ArgType type, const char* list, char delimiter);
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Reads the value(s) of an argument of the given type like OptionValue::read,
+		// reporting each of them instead of storing.
+		SCLAP_INLINE bool visitArgument(VisitContext& context, ArgType type, int& inOutCurIndex,
+			char** inOutCurArgumentStr, int argc, char** inArgv);
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Parses argv like Options, but reports every option and value to visitor instead
+	// of storing them. Options of one argument (-abc 1 2) receive each of its values.
+	// Memory use does not depend on argc. Values before a malformed one are already
+	// reported when parsing fails.
+	// Returns false on an error (stored to outError) or when visitor stopped parsing.
+	SCLAP_INLINE bool visitOptions(const DescriptorSet& descriptors, int argc, char** argv,
+		OptionVisitor& visitor, Error* outError = NULL);
+
+#ifndef SCLAP_NO_THREADS
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// argv of one command line of parseBatch.
+	struct CommandLine
+	{
+		int argc;
+		char** argv;
+	};
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	namespace hidden
+	{
+		// Task indices [begin, end) of a worker packed into one word, so the owner taking
+		// from the front and thieves taking the back half agree by compare and swap.
+		class WorkRange
+		{
+		public:
+			WorkRange() : mRange(0) {}
+
+			void reset(uint32_t begin, uint32_t end) { mRange.store(pack(begin, end)); }
+
+			bool pop(uint32_t& outIndex)
+			{
+				uint64_t range = mRange.load();
+				for (;;)
+				{
+					const uint32_t begin = (uint32_t)(range >> 32);
+					const uint32_t end = (uint32_t)range;
+					if (begin >= end) return false;
+
+					if (mRange.compare_exchange_weak(range, pack(begin + 1, end)))
+					{
+						outIndex = begin;
+						return true;
+					}
+				}
+			}
+
+			// Takes the back half. The last task is left to the owner, so a single
+			// task cannot move between thieves without running.
+			bool steal(uint32_t& outBegin, uint32_t& outEnd)
+			{
+				uint64_t range = mRange.load();
+				for (;;)
+				{
+					const uint32_t begin = (uint32_t)(range >> 32);
+					const uint32_t end = (uint32_t)range;
+					if (begin + 1 >= end) return false;
+
+					const uint32_t middle = begin + (end - begin) / 2;
+					if (mRange.compare_exchange_weak(range, pack(begin, middle)))
+					{
+						outBegin = middle;
+						outEnd = end;
+						return true;
+					}
+				}
+			}
+
+		private:
+			std::atomic<uint64_t> mRange;
+
+			static uint64_t pack(uint32_t begin, uint32_t end)
+			{
+				return ((uint64_t)begin << 32) | end;
+			}
+		};
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Runs task(i) for i in [0, count) on threads workers (the calling thread is one
+		// of them). Every worker starts with an equal slice and steals from the others
+		// when its slice is done.
+		template <typename Task>
+		void runWorkStealing(size_t count, unsigned threads, const Task& task)
+		{
+			if (threads > count) threads = (unsigned)count;
+			if (threads <= 1)
+			{
+				for (size_t i = 0; i < count; ++i) task(i);
+				return;
+			}
+
+			std::vector<WorkRange> ranges(threads);
+			for (unsigned w = 0; w < threads; ++w)
+			{
+				ranges[w].reset((uint32_t)(count * w / threads), (uint32_t)(count * (w + 1) / threads));
+			}
+
+			struct Worker
+			{
+				static void run(std::vector<WorkRange>& ranges, unsigned self, const Task& task)
+				{
+					const unsigned threads = (unsigned)ranges.size();
+					for (;;)
+					{
+						uint32_t index;
+						while (ranges[self].pop(index)) task(index);
+
+						uint32_t begin, end;
+						bool stolen = false;
+						for (unsigned i = 1; i < threads && !stolen; ++i)
+						{
+							stolen = ranges[(self + i) % threads].steal(begin, end);
+						}
+						if (!stolen) return;
+
+						ranges[self].reset(begin, end);
+					}
+				}
+			};
+
+			std::vector<std::thread> workers;
+			for (unsigned w = 1; w < threads; ++w)
+			{
+				workers.push_back(std::thread(&Worker::run, std::ref(ranges), w, std::cref(task)));
+			}
+			Worker::run(ranges, 0, task);
+
+			for (size_t i = 0; i < workers.size(); ++i)
+			{
+				workers[i].join();
+			}
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		struct ParseTask
+		{
+			const DescriptorSet& descriptors;
+			const std::vector<CommandLine>& commandLines;
+			std::vector<std::unique_ptr<Options> >& results;
+			uint32_t flags;
+
+			void operator()(size_t i) const
+			{
+				results[i].reset(new Options(descriptors, commandLines[i].argc,
+					commandLines[i].argv, NULL, flags));
+			}
+		};
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Parses every command line against descriptors on threads threads (all cores
+	// for 0), result i belongs to commandLines[i]. The descriptors and argv arrays
+	// must outlive the results. Define SCLAP_NO_THREADS to build without threads.
+	SCLAP_INLINE std::vector<std::unique_ptr<Options> > parseBatch(const DescriptorSet& descriptors,
+		const std::vector<CommandLine>& commandLines, unsigned threads = 0,
+		uint32_t flags = PARSE_DEFAULT);
+#endif // !SCLAP_NO_THREADS
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+} // end of sclap
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+// Out of line definitions: inline in the header-only mode, compiled once by sclap.cpp in the library mode.
+#ifndef SCLAP_DECLARATIONS_ONLY
+
+// Only used by the definitions (files), library users do not see them.
+#include <cstdio>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sclap
+{
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	namespace hidden
+	{
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE uint32_t hashName(const char* name, size_t size)
+		{
+			uint32_t hash = 2166136261u;
+			for (size_t i = 0; i < size; ++i)
+			{
+				hash ^= (unsigned char)name[i];
+				hash *= 16777619u;
+			}
+			return hash;
+		}
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE std::string Error::str() const
+	{
+		switch (code)
+		{
+		case ERROR_LONG_NAME_LENGTH: return "Long option length cant be 1: " + subject + ".\n";
+		case ERROR_NOT_AN_OPTION: return "Error: " + subject + ". Is not an option.\n";
+		case ERROR_ZERO_LENGTH_OPTION: return "Error: " + subject + ". Zero length option.\n";
+		case ERROR_UNKNOWN_SHORT_OPTION: return "Error: " + subject + " is not existing option.\n";
+		case ERROR_REPEATED_SHORT_OPTION: return "Error: " + subject + ". Same option multiple times.\n";
+		case ERROR_OPTION_EXPECTED: return "Error: " + subject + ". Option expected.\n";
+		case ERROR_READ_ARGUMENT: return "Error: " + subject + ". Failed to read argument.\n";
+		case ERROR_RESPONSE_FILE: return "Error: " + subject + ". Can not read response file.\n";
+		case ERROR_ENVIRONMENT: return "Error: " + subject + ". Can not read the value of environment variable.\n";
+		case ERROR_CONFIG_FILE: return "Error: " + subject + ". Can not read config file.\n";
+		case ERROR_WIDE_SHARED_ARGUMENT: return "Error: " + subject
+			+ ". A 64 bit option can not share an argument with options of this type.\n";
+		case ERROR_CONFIG_LINE: return "Error: " + subject + ". Invalid config file line "
+			+ std::to_string(argumentIndex) + ".\n";
+		default: return "Error: " + subject + ".\n";
+		}
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	namespace hidden
+	{
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE std::string formatErrors(const std::vector<Error>& errors)
+		{
+			std::string text;
+			for (size_t i = 0; i < errors.size(); ++i)
+			{
+				text += errors[i].str();
+			}
+			return text;
+		}
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE const DescriptorView* DescriptorSet::find(const char* opt, size_t size) const
+	{
+		if (size == 0) { return NULL; }
+
+		if (size == 1)
+		{
+			return findShort(opt[0]);
+		}
+
+		return findLong(opt, size);
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE OptionDescriptors::OptionDescriptors(const std::vector<OptionDescriptor>& descriptors)
+		: mDescriptors(), mErrors(), mOk(false)
+	{
+		clearIndex();
+		for (size_t i = 0; i < descriptors.size(); ++i)
+		{
+			add(descriptors[i]);
+		}
+		check(0);
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE OptionDescriptors::OptionDescriptors(const OptionDescriptors& optDesc)
+		: mDescriptors(), mErrors(optDesc.mErrors), mOk(optDesc.mOk)
+	{
+		clearIndex();
+		for (size_t i = 0; i < optDesc.mDescriptors.size(); ++i)
+		{
+			add(optDesc.mDescriptors[i]);
+		}
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE void OptionDescriptors::clearIndex()
+	{
+		for (size_t i = 0; i < 256; ++i)
+		{
+			mShortIndex[i] = hidden::NameIndex::NONE;
+		}
+		mLongIndex = hidden::NameIndex();
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Lookup returns the first matching descriptor, so already indexed names are kept.
+	SCLAP_INLINE void OptionDescriptors::add(const OptionDescriptor& desc)
+	{
+		mDescriptors.push_back(desc);
+
+		const int i = (int)mDescriptors.size() - 1;
+		if (desc.environmentName()) mEnvironment.push_back(i);
+
+		const unsigned char shortName = (unsigned char)desc.shortName();
+		if (shortName != OPT_SHORT_NONE && mShortIndex[(unsigned char)shortName] == hidden::NameIndex::NONE)
+		{
+			mShortIndex[(unsigned char)shortName] = i;
+		}
+
+		if (desc.longNameSize())
+		{
+			const hidden::DescriptorLongNameEqual equal = { mDescriptors };
+			mLongIndex.insert(desc.longNameView().data(), desc.longNameSize(), i, equal);
+		}
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Checks the descriptors from first on, the others were checked before.
+	SCLAP_INLINE void OptionDescriptors::check(size_t first)
+	{
+		for (size_t i = first; i < mDescriptors.size(); ++i)
+		{
+			if (mDescriptors[i].longNameSize() == 1)
+			{
+				mErrors.push_back(hidden::makeError(ERROR_LONG_NAME_LENGTH,
+					mDescriptors[i].longNameView().data(), 1, -1, 0));
+			}
+		}
+
+		mOk = true;
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE const DescriptorView* OptionDescriptors::findLong(const char* opt, size_t size) const
+	{
+		const hidden::DescriptorLongNameEqual equal = { mDescriptors };
+		const int i = mLongIndex.find(opt, size, equal);
+
+		return i == hidden::NameIndex::NONE ? NULL : &mDescriptors[i];
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE const DescriptorView* OptionDescriptors::findShort(char opt) const
+	{
+		const int i = mShortIndex[(unsigned char)opt];
+
+		return i == hidden::NameIndex::NONE ? NULL : &mDescriptors[i];
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE CompiledDescriptors::CompiledDescriptors(const OptionDescriptors& descriptors)
+		: mDescriptors(descriptors.mDescriptors), mLongIndex(descriptors.mLongIndex),
+		mEnvironment(descriptors.mEnvironment), mErrors(descriptors.mErrors), mOk(descriptors.mOk)
+	{
+		// the tables hold positions only, they stay valid for the copied descriptors
+		memcpy(mShortIndex, descriptors.mShortIndex, sizeof(mShortIndex));
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE const DescriptorView* CompiledDescriptors::findLong(const char* opt, size_t size) const
+	{
+		const hidden::DescriptorLongNameEqual equal = { mDescriptors };
+		const int i = mLongIndex.find(opt, size, equal);
+
+		return i == hidden::NameIndex::NONE ? NULL : &mDescriptors[i];
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE const DescriptorView* CompiledDescriptors::findShort(char opt) const
+	{
+		const int i = mShortIndex[(unsigned char)opt];
+
+		return i == hidden::NameIndex::NONE ? NULL : &mDescriptors[i];
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE std::shared_ptr<const CompiledDescriptors> OptionDescriptors::compile() const
+	{
+		return std::make_shared<const CompiledDescriptors>(*this);
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE void* Arena::allocate(size_t size, size_t alignment)
+	{
+		size_t padding = (alignment - (size_t)mCur % alignment) % alignment;
+
+		if (mCur == NULL || (size_t)(mEnd - mCur) < padding + size)
+		{
+			if (mNextBlockSize < size + alignment) mNextBlockSize = size + alignment;
+			if (mNextBlockSize < 64) mNextBlockSize = 64;
+
+			SCLAP_STAT(hidden::addStat(&ParseStats::allocations, 1));
+			SCLAP_STAT(hidden::addStat(&ParseStats::allocatedBytes, sizeof(Block) + mNextBlockSize));
+			Block* block = (Block*)::operator new(sizeof(Block) + mNextBlockSize);
+			block->next = mBlocks;
+			block->size = mNextBlockSize;
+			mBlocks = block;
+
+			mCur = (char*)(block + 1);
+			mEnd = mCur + mNextBlockSize;
+			mNextBlockSize *= 2;
+
+			padding = (alignment - (size_t)mCur % alignment) % alignment;
+		}
+
+		void* ptr = mCur + padding;
+		mCur += padding + size;
+		return ptr;
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE void Arena::release()
+	{
+		while (mBlocks)
+		{
+			Block* next = mBlocks->next;
+			::operator delete(mBlocks);
+			mBlocks = next;
+		}
+
+		mCur = mBuffer;
+		mEnd = mBuffer + mBufferSize;
+		mNextBlockSize = mBlockSize;
+	}
+
+#ifdef _WIN32
+
+	namespace hidden
+	{
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool MappedFile::open(const char* path)
+		{
+			close();
+
+			FILE* file = fopen(path, "rb");
+			if (!file) return false;
+
+			fseek(file, 0, SEEK_END);
+			const long size = ftell(file);
+			fseek(file, 0, SEEK_SET);
+
+			bool res = size >= 0;
+			if (res)
+			{
+				mData = new char[size + 1];
+				mSize = fread(mData, 1, size, file);
+				mData[mSize] = '\0';
+				res = mSize == (size_t)size;
+			}
+
+			fclose(file);
+			return res;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE void MappedFile::close()
+		{
+			delete[] mData;
+			mData = NULL;
+			mSize = 0;
+		}
+	}
+
+#else
+
+	namespace hidden
+	{
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool MappedFile::open(const char* path)
+		{
+			close();
+
+			const int fd = ::open(path, O_RDONLY);
+			if (fd < 0) return false;
+
+			struct stat info;
+			if (fstat(fd, &info) != 0)
+			{
+				::close(fd);
+				return false;
+			}
+
+			// Reserve one byte more than the file: the part past its last page is
+			// anonymous zeroed memory, so the text is always followed by '\0'.
+			const size_t size = (size_t)info.st_size;
+			void* reserved = mmap(NULL, size + 1, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (reserved == MAP_FAILED)
+			{
+				::close(fd);
+				return false;
+			}
+
+			if (size && mmap(reserved, size, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+			{
+				munmap(reserved, size + 1);
+				::close(fd);
+				return false;
+			}
+
+			::close(fd);
+			madvise(reserved, size + 1, MADV_SEQUENTIAL);
+
+			mData = static_cast<char*>(reserved);
+			mSize = size;
+			mMappedSize = size + 1;
+			return true;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE void MappedFile::close()
+		{
+			if (mData) munmap(mData, mMappedSize);
+			mData = NULL;
+			mSize = 0;
+			mMappedSize = 0;
+		}
+	}
+
+#endif
+
+	namespace hidden
+	{
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE char* nextToken(char*& inOutCur, char* end)
+		{
+			char* cur = inOutCur;
+			while (cur != end && isSpace(*cur)) ++cur;
+			if (cur == end)
+			{
+				inOutCur = cur;
+				return NULL;
+			}
+
+			char* token = cur;
+			char* out = cur;
+			char quote = '\0';
+			while (cur != end)
+			{
+				char* run = (char*)findTokenBreak(cur, end);
+				if (run != cur)
+				{
+					if (out != cur) memmove(out, cur, run - cur);
+					out += run - cur;
+					cur = run;
+					if (cur == end) break;
+				}
+
+				char c = *cur;
+				if (quote == '\0')
+				{
+					if (isSpace(c)) break;
+					if (c == '\'' || c == '"')
+					{
+						quote = c;
+						++cur;
+						continue;
+					}
+				}
+				else if (c == quote)
+				{
+					quote = '\0';
+					++cur;
+					continue;
+				}
+
+				if (c == '\\' && quote != '\'' && cur + 1 != end)
+				{
+					c = *++cur;
+				}
+
+				*out++ = c;
+				++cur;
+			}
+
+			// skip the separator, then terminate (out never passes it)
+			if (cur != end) ++cur;
+			*out = '\0';
+
+			inOutCur = cur;
+			return token;
+		}
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE ArgType OptionValue::type() const {
+		return 0;
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	namespace hidden
+	{
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE NumberResult parseReal(const char* first, const char* last, double& value)
+		{
+			static const double powersOfTen[] = {
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+			};
+
+			const char* p = first;
+
+			bool negative = false;
+			if (p != last && (*p == '-' || *p == '+'))
+			{
+				negative = *p == '-';
+				++p;
+			}
+
+			if (startsWithWord(p, last, "inf"))
+			{
+				p += startsWithWord(p, last, "infinity") ? 8 : 3;
+				value = negative ? -std::numeric_limits<double>::infinity()
+					: std::numeric_limits<double>::infinity();
+				NumberResult res = { p, std::errc() };
+				return res;
+			}
+			if (startsWithWord(p, last, "nan"))
+			{
+				value = std::numeric_limits<double>::quiet_NaN();
+				NumberResult res = { p + 3, std::errc() };
+				return res;
+			}
+
+			uint64_t mantissa = 0;
+			int significantDigits = 0;
+			int exponent = 0;
+			bool anyDigits = false;
+			bool truncated = false;
+
+			for (; p != last && isDigit(*p); ++p)
+			{
+				anyDigits = true;
+				if (mantissa == 0 && *p == '0') continue;
+
+				if (significantDigits <= 11 && last - p >= 8 && isEightDigits(p))
+				{
+					mantissa = mantissa * 100000000 + parseEightDigits(p);
+					significantDigits += 8;
+					p += 7;
+				}
+				else if (significantDigits < 19)
+				{
+					mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+					++significantDigits;
+				}
+				else
+				{
+					++exponent;
+					truncated = truncated || *p != '0';
+				}
+			}
+
+			if (p != last && *p == '.')
+			{
+				++p;
+				for (; p != last && isDigit(*p); ++p)
+				{
+					anyDigits = true;
+					if (mantissa == 0 && *p == '0')
+					{
+						--exponent;
+						continue;
+					}
+
+					if (significantDigits <= 11 && last - p >= 8 && isEightDigits(p))
+					{
+						mantissa = mantissa * 100000000 + parseEightDigits(p);
+						significantDigits += 8;
+						exponent -= 8;
+						p += 7;
+					}
+					else if (significantDigits < 19)
+					{
+						mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+						++significantDigits;
+						--exponent;
+					}
+					else
+					{
+						truncated = truncated || *p != '0';
+					}
+				}
+			}
+
+			if (!anyDigits)
+			{
+				NumberResult res = { first, std::errc::invalid_argument };
+				return res;
+			}
+
+			if (p != last && (*p == 'e' || *p == 'E'))
+			{
+				const char* e = p + 1;
+				bool negativeExponent = false;
+				if (e != last && (*e == '-' || *e == '+'))
+				{
+					negativeExponent = *e == '-';
+					++e;
+				}
+
+				// exponent without digits is not a part of the number
+				if (e != last && isDigit(*e))
+				{
+					int exponentValue = 0;
+					for (; e != last && isDigit(*e); ++e)
+					{
+						if (exponentValue < 100000) exponentValue = exponentValue * 10 + (*e - '0');
+					}
+
+					exponent += negativeExponent ? -exponentValue : exponentValue;
+					p = e;
+				}
+			}
+
+			if (mantissa == 0)
+			{
+				value = negative ? -0.0 : 0.0;
+				NumberResult res = { p, std::errc() };
+				return res;
+			}
+
+			if (!truncated && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+			{
+				value = exponent < 0 ? (double)mantissa / powersOfTen[-exponent]
+					: (double)mantissa * powersOfTen[exponent];
+				if (negative) value = -value;
+
+				NumberResult res = { p, std::errc() };
+				return res;
+			}
+
+			std::istringstream stream(std::string(first, p));
+			stream.imbue(std::locale::classic());
+			stream >> value;
+
+			// the syntax is already checked, so failure means overflow
+			if (stream.fail() || std::fabs(value) == std::numeric_limits<double>::infinity())
+			{
+				NumberResult res = { p, std::errc::result_out_of_range };
+				return res;
+			}
+
+			NumberResult res = { p, std::errc() };
+			return res;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool toInteger(const char* s, int& val)
+		{
+			SCLAP_STAT(addStat(&ParseStats::intConversions, 1));
+			const char* end = s + strlen(s);
+			const NumberResult res = parseInteger(s, end, val);
+			return res.ec == std::errc() && res.ptr == end;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool toDouble(const char* s, double& val)
+		{
+			SCLAP_STAT(addStat(&ParseStats::realConversions, 1));
+			const char* end = s + strlen(s);
+			const NumberResult res = parseReal(s, end, val);
+			return res.ec == std::errc() && res.ptr == end;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool toInteger64(const char* s, int64_t& val)
+		{
+			SCLAP_STAT(addStat(&ParseStats::int64Conversions, 1));
+			const char* end = s + strlen(s);
+			const NumberResult res = parseInteger(s, end, val);
+			return res.ec == std::errc() && res.ptr == end;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool toUnsigned64(const char* s, uint64_t& val)
+		{
+			SCLAP_STAT(addStat(&ParseStats::uint64Conversions, 1));
+			const char* end = s + strlen(s);
+			const NumberResult res = parseInteger(s, end, val);
+			return res.ec == std::errc() && res.ptr == end;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool toSize(const char* s, uint64_t& val)
+		{
+			SCLAP_STAT(addStat(&ParseStats::uint64Conversions, 1));
+			const char* end = s + strlen(s);
+			const NumberResult res = parseInteger(s, end, val);
+			if (res.ec != std::errc()) return false;
+			if (res.ptr == end) return true;
+			if (res.ptr + 1 != end) return false;
+
+			unsigned shift;
+			switch (*res.ptr)
+			{
+			case 'K': case 'k': shift = 10; break;
+			case 'M': case 'm': shift = 20; break;
+			case 'G': case 'g': shift = 30; break;
+			default: return false;
+			}
+
+			if (val > (std::numeric_limits<uint64_t>::max() >> shift)) return false;
+			val <<= shift;
+			return true;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool isSingleArgType(ArgType type)
+		{
+			switch (type)
+			{
+			case ARG_STRING: case ARG_BOOL: case ARG_INT: case ARG_REAL:
+			case ARG_INT64: case ARG_UINT64: case ARG_SIZE:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool readInt(int& inOutCurIndex, char** inOutCurArgumentStr,
+			char** inArgv, int &outInteger)
+		{
+			bool res = hidden::toInteger(*inOutCurArgumentStr, outInteger);
+			if (res)
+			{
+				++inOutCurIndex;
+				*inOutCurArgumentStr = inArgv[inOutCurIndex];
+			}
+			return res;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool readDouble(int& inOutCurIndex, char** inOutCurArgumentStr,
+			char** inArgv, double &outDouble)
+		{
+			bool res = hidden::toDouble(*inOutCurArgumentStr, outDouble);
+			if (res)
+			{
+				++inOutCurIndex;
+				*inOutCurArgumentStr = inArgv[inOutCurIndex];
+			}
+			return res;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool readString(int& inOutCurIndex, char** inOutCurArgumentStr,
+			char** inArgv, StringView &outString)
+		{
+			if (**inOutCurArgumentStr != '\0')
+			{
+				outString = StringView(*inOutCurArgumentStr);
+				++inOutCurIndex;
+				*inOutCurArgumentStr = inArgv[inOutCurIndex];
+			}
+			else
+			{
+				return false;
+			}
+			return true;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE ArgType getTypeToRead(ArgType single, ArgType vector)
+		{
+			if (vector == ARG_REAL_VEC) return ARG_REAL_VEC;
+			else if (vector == ARG_FLOAT_VEC) {
+				if (single == ARG_REAL) return ARG_REAL_VEC;
+				else return ARG_FLOAT_VEC;
+			}
+			else if (vector == ARG_INT_VEC) {
+				  if (single == ARG_REAL) return ARG_REAL_VEC;
+				  else return ARG_INT_VEC;
+			}
+			else if (vector == ARG_BOOL_VEC)
+			{
+				if (single == ARG_REAL) return ARG_REAL_VEC;
+				else if (single == ARG_INT) return ARG_INT_VEC;
+				else return ARG_BOOL_VEC;
+			}
+			else if (vector == ARG_STRING_VEC) {
+				if (single == ARG_REAL) return ARG_REAL_VEC;
+				else if (single == ARG_INT) return ARG_INT_VEC;
+				else return ARG_STRING_VEC;
+			}
+			else return single;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE const OptionValueUnexisted& unexisted()
+		{
+			static const OptionValueUnexisted value = OptionValueUnexisted();
+			return value;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool OptionValueBool::read(int& inOutCurIndex, char** inOutCurArgumentStr,
+			int argc, char** inArgv)
+		{
 			if (inOutCurIndex < argc) 
 			{	
 				if (!strcmp(*inOutCurArgumentStr, "true"))
@@ -387,735 +4204,1523 @@ namespace sclap
 				}
 				else if (!strcmp(*inOutCurArgumentStr, "false"))
 				{
-					++inOutCurIndex;
-					*inOutCurArgumentStr = inArgv[inOutCurIndex];
-					mValue = false;
-					return true;
-				}	
+					++inOutCurIndex;
+					*inOutCurArgumentStr = inArgv[inOutCurIndex];
+					mValue = false;
+					return true;
+				}	
+			}
+
+			mValue = true;
+			return true;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool OptionValueBoolVector::read(int& inOutCurIndex, char** inOutCurArgumentStr,
+			int argc, char** inArgv)
+		{
+			if (isPackedList(*inOutCurArgumentStr, inOutCurIndex, argc, inArgv, mDelimiter))
+			{
+				return readPackedList(mValue, mDelimiter, inOutCurIndex, inOutCurArgumentStr, inArgv);
+			}
+
+			int startIndex = inOutCurIndex;
+			char** startArgument = inOutCurArgumentStr;
+
+			mValue.clear();
+
+			StringView strArg;
+			while (inOutCurIndex < argc 
+				&& **inOutCurArgumentStr != '-' 
+				&& **inOutCurArgumentStr != '\0')
+			{
+				if (readString(inOutCurIndex, inOutCurArgumentStr, inArgv, strArg))
+				{
+					if (strArg == "True" || strArg == "true")
+					{
+						mValue.push_back(true);
+					}
+					else if (strArg == "False" || strArg == "false")
+					{
+						mValue.push_back(false);
+					}
+					else
+					{
+						inOutCurArgumentStr = startArgument;
+						inOutCurIndex = startIndex;
+						return false;
+					}
+				}
+			}
+
+			return mValue.size() > 0;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE const std::vector<std::string> OptionValueBoolVector::asStringVector() const
+		{
+			std::vector<std::string> ret(mValue.size());
+			for (size_t i = 0; i < mValue.size(); ++i)
+			{
+				ret[i] = mValue[i] ? "true" : "false";
+			}
+
+			return ret;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE size_t OptionValueIntVector::size() const
+		{
+			size_t size = mValue.size();
+			for (size_t i = 0; i < mRanges.size(); ++i)
+			{
+				size += (size_t)((int64_t)mRanges[i].last - mRanges[i].first + 1);
+			}
+			return size;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE const OptionValueIntVector::Values& OptionValueIntVector::values() const
+		{
+			if (mRanges.empty()) return mValue;
+
+			Values expanded(mValue.get_allocator());
+			expanded.reserve(size());
+
+			size_t next = 0;
+			for (size_t i = 0; i < mRanges.size(); ++i)
+			{
+				const Range& range = mRanges[i];
+				expanded.insert(expanded.end(), mValue.begin() + next, mValue.begin() + range.position);
+				next = range.position;
+
+				for (int64_t value = range.first; value <= range.last; ++value)
+				{
+					expanded.push_back((int)value);
+				}
+			}
+			expanded.insert(expanded.end(), mValue.begin() + next, mValue.end());
+
+			mValue.swap(expanded);
+			mRanges.clear();
+			return mValue;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE Span<double> OptionValueIntVector::asRealSpan() const
+		{
+			if (mRealCache.empty())
+			{
+				const Values& value = values();
+				mRealCache.reserve(value.size());
+				for (size_t i = 0; i < value.size(); ++i)
+				{
+					mRealCache.push_back(value[i]);
+				}
+			}
+
+			return Span<double>(mRealCache.data(), mRealCache.size());
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE Span<bool> OptionValueIntVector::asBoolSpan() const
+		{
+			if (mBoolCache.empty())
+			{
+				const Values& value = values();
+				mBoolCache.reserve(value.size());
+				for (size_t i = 0; i < value.size(); ++i)
+				{
+					mBoolCache.push_back(value[i] != 0);
+				}
+			}
+
+			return Span<bool>(mBoolCache.data(), mBoolCache.size());
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE const std::vector<std::string> OptionValueIntVector::asStringVector() const
+		{
+			const Values& value = values();
+			std::vector<std::string> ret(value.size());
+			for (size_t i = 0; i < value.size(); ++i)
+			{
+				ret[i] = hidden::numberToString(value[i]);
+			}
+
+			return ret;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool OptionValueIntVector::read(int& inOutCurIndex, char** inOutCurArgumentStr,
+			int argc, char** inArgv)
+		{
+			mRanges.clear();
+
+			if (isPackedList(*inOutCurArgumentStr, inOutCurIndex, argc, inArgv, mDelimiter))
+			{
+				if (!readPacked(*inOutCurArgumentStr)) return false;
+
+				++inOutCurIndex;
+				*inOutCurArgumentStr = inArgv[inOutCurIndex];
+				return true;
+			}
+
+			return readVector(mValue, inOutCurIndex, inOutCurArgumentStr, argc, inArgv);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		// Like readPackedList, ranges are only recorded.
+		SCLAP_INLINE bool OptionValueIntVector::readPacked(const char* list)
+		{
+			mValue.clear();
+
+			size_t rangeValues = 0;
+			StringView element;
+			while (nextListElement(list, mDelimiter, element))
+			{
+				int first, last;
+				if (!toRange(element, first, last) || !countRange(rangeValues, first, last))
+				{
+					mValue.clear();
+					mRanges.clear();
+					return false;
+				}
+
+				if (first == last)
+				{
+					mValue.push_back(first);
+				}
+				else
+				{
+					const Range range = { mValue.size(), first, last };
+					mRanges.push_back(range);
+				}
 			}
 
-			mValue = true;
 			return true;
 		}
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
-		/*--------------------------------------------------------------------------------------------*/
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		class OptionValueInt : public OptionValue
+		SCLAP_INLINE const std::vector<std::string> OptionValueRealVector::asStringVector() const
 		{
-		public:
-			virtual const std::string asString() const { return hidden::numberToString(mValue); };
-			virtual double asReal() const { return mValue; };
-			virtual int asInteger() const { return mValue; };
-			virtual bool asBool() const { return mValue; };
+			std::vector<std::string> ret(mValue.size());
+			for (size_t i = 0; i < mValue.size(); ++i)
+			{
+				ret[i] = hidden::numberToString(mValue[i]);
+			}
 
-			virtual const std::vector<std::string> asStringVector() const
+			return ret;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool OptionValueRealVector::read(int& inOutCurIndex, char** inOutCurArgumentStr,
+			int argc, char** inArgv)
+		{
+			if (isPackedList(*inOutCurArgumentStr, inOutCurIndex, argc, inArgv, mDelimiter))
 			{
-				return std::vector<std::string>(1, asString());
+				return readPackedList(mValue, mDelimiter, inOutCurIndex, inOutCurArgumentStr, inArgv);
 			}
-			virtual const std::vector<double> asRealVector() const
+
+			return readVector(mValue, inOutCurIndex, inOutCurArgumentStr, argc, inArgv);
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE const std::vector<std::string> OptionValueFloatVector::asStringVector() const
+		{
+			std::vector<std::string> ret(mValue.size());
+			for (size_t i = 0; i < mValue.size(); ++i)
 			{
-				return std::vector<double>(1, asReal());
+				ret[i] = hidden::numberToString(mValue[i]);
 			}
-			virtual const std::vector<int> asIntegerVector() const
+
+			return ret;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE Span<double> OptionValueFloatVector::asRealSpan() const
+		{
+			if (mRealCache.empty())
 			{
-				return std::vector<int>(1, asInteger());
+				mRealCache.reserve(mValue.size());
+				for (size_t i = 0; i < mValue.size(); ++i)
+				{
+					mRealCache.push_back(mValue[i]);
+				}
 			}
-			virtual const std::vector<bool> asBoolVector() const
+
+			return Span<double>(mRealCache.data(), mRealCache.size());
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool OptionValueFloatVector::read(int& inOutCurIndex, char** inOutCurArgumentStr,
+			int argc, char** inArgv)
+		{
+			if (isPackedList(*inOutCurArgumentStr, inOutCurIndex, argc, inArgv, mDelimiter))
 			{
-				return std::vector<bool>(1, asBool());
+				return readPackedList(mValue, mDelimiter, inOutCurIndex, inOutCurArgumentStr, inArgv);
 			}
 
-			virtual uint8_t type() const { return ARG_INT; }
+			return readVector(mValue, inOutCurIndex, inOutCurArgumentStr, argc, inArgv);
+		}
 
-			virtual bool read(int& inOutCurIndex,
-				char** inOutCurArgumentStr, int argc, char** inArgv)
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE const std::vector<std::string> OptionValueStringVector::asStringVector() const
+		{
+			std::vector<std::string> ret(mValue.size());
+			for (size_t i = 0; i < mValue.size(); ++i)
 			{
-				return readInt(inOutCurIndex, inOutCurArgumentStr, inArgv, mValue);
+				ret[i] = mValue[i].str();
 			}
 
-		private:
-			int mValue;
-		};
+			return ret;
+		}
 
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
-		/*--------------------------------------------------------------------------------------------*/
+
+		SCLAP_INLINE bool OptionValueStringVector::read(int& inOutCurIndex, char** inOutCurArgumentStr,
+			int argc, char** inArgv)
+		{
+			if (isPackedList(*inOutCurArgumentStr, inOutCurIndex, argc, inArgv, mDelimiter))
+			{
+				if (!readPackedList(mValue, mDelimiter, inOutCurIndex, inOutCurArgumentStr, inArgv))
+				{
+					return false;
+				}
+				if (mShouldCopy) copyValues();
+				return true;
+			}
+
+			mValue.clear();
+
+			StringView strArg;
+			while (inOutCurIndex < argc
+				&& **inOutCurArgumentStr != '-'
+				&& **inOutCurArgumentStr != '\0')
+			{
+				if (readString(inOutCurIndex, inOutCurArgumentStr, inArgv, strArg))
+				{
+					mValue.push_back(strArg);
+				}
+			}
+
+			if (mShouldCopy) copyValues();
+
+			return mValue.size() > 0;
+		}
+
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		class OptionValueReal : public OptionValue
+		// Copies all values into a single buffer (null separated) and points the views to it.
+		SCLAP_INLINE void OptionValueStringVector::copyValues()
 		{
-		public:
-			virtual const std::string asString() const { return hidden::numberToString(mValue); };
-			virtual double asReal() const { return mValue; };
-			virtual int asInteger() const { return (int)mValue; };
+			size_t size = 0;
+			for (size_t i = 0; i < mValue.size(); ++i)
+			{
+				size += mValue[i].size() + 1;
+			}
 
-			virtual const std::vector<std::string> asStringVector() const
+			mCopy.clear();
+			mCopy.reserve(size);
+			for (size_t i = 0; i < mValue.size(); ++i)
 			{
-				return std::vector<std::string>(1, asString());
+				mCopy.append(mValue[i].data(), mValue[i].size());
+				mCopy.push_back('\0');
 			}
-			virtual const std::vector<double> asRealVector() const
+
+			const char* data = mCopy.data();
+			for (size_t i = 0; i < mValue.size(); ++i)
 			{
-				return std::vector<double>(1, asReal());
+				mValue[i] = StringView(data, mValue[i].size());
+				data += mValue[i].size() + 1;
 			}
+		}
 
-			virtual uint8_t type() const { return ARG_REAL; }
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-			virtual bool read(int& inOutCurIndex,
-				char** inOutCurArgumentStr, int argc, char** inArgv)
+		SCLAP_INLINE bool readOptionNames(const DescriptorSet& descriptors, int& inOutCurIndex,
+			char** inOutCurArgumentStr, char** inArgv, ArgumentOptions& outOptions, Error& outError)
+		{
+			outOptions.clear();
+
+			if (**inOutCurArgumentStr == '-')
 			{
-				return readDouble(inOutCurIndex, inOutCurArgumentStr, inArgv, mValue);
+				char* name = *inOutCurArgumentStr + 1;
+				// -- (long option)
+				if (*name == '-')
+				{
+					++name;
+					char* nameEnd = name;
+					while ((*nameEnd != '=') && (*nameEnd != '\0')) ++nameEnd;
+
+					const size_t size = nameEnd - name;
+					SCLAP_STAT(addStat(&ParseStats::lookups, 1));
+					const DescriptorView* desc = descriptors.find(name, size);
+					if (!desc)
+					{
+						const char* argument = inArgv[inOutCurIndex];
+						outError = size
+							? makeError(ERROR_NOT_AN_OPTION, name, size, inOutCurIndex, name - argument)
+							: makeError(ERROR_ZERO_LENGTH_OPTION, argument, strlen(argument),
+								inOutCurIndex, 0);
+						return false;
+					}
+					outOptions.addLong(desc);
+
+					*inOutCurArgumentStr = nameEnd;
+				}
+				// - (short option(s))
+				else
+				{
+					for (; (*name != '=') && (*name != '\0'); ++name)
+					{
+						SCLAP_STAT(addStat(&ParseStats::lookups, 1));
+						const DescriptorView* desc = descriptors[*name];
+						if (!desc)
+						{
+							outError = makeError(ERROR_UNKNOWN_SHORT_OPTION, name, 1,
+								inOutCurIndex, name - inArgv[inOutCurIndex]);
+							return false;
+						}
+						if (!outOptions.addShort(*name, desc))
+						{
+							outError = makeError(ERROR_REPEATED_SHORT_OPTION, name, 1,
+								inOutCurIndex, name - inArgv[inOutCurIndex]);
+							return false;
+						}
+					}
+
+					*inOutCurArgumentStr = name;
+				}
+
+				if (**inOutCurArgumentStr == '\0')
+				{
+					++inOutCurIndex;
+					*inOutCurArgumentStr = inArgv[inOutCurIndex];
+				}
+				else
+				{
+					// skip '='
+					++* inOutCurArgumentStr;
+				}
+			}
+			// not option
+			else
+			{
+				outError = makeError(ERROR_OPTION_EXPECTED, *inOutCurArgumentStr,
+					strlen(*inOutCurArgumentStr), inOutCurIndex, *inOutCurArgumentStr - inArgv[inOutCurIndex]);
+				return false;
 			}
 
-		private:
-			double mValue;
-		};
+			return true;
+		}
 
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
-		/*--------------------------------------------------------------------------------------------*/
+
+		SCLAP_INLINE ArgType valueType(const ArgumentOptions& options)
+		{
+			bool onlyFlags = true;
+			ArgType types = 0;
+			ArgType typeVector = 0;
+			ArgType typeSingle = 1;
+			for (size_t i = 0; i < options.size; ++i)
+			{
+				const ArgType curPossibleArgumentValues = options.descriptors[i]->possibleArgumentValues();
+				onlyFlags = onlyFlags && (curPossibleArgumentValues == ARG_BOOL);
+				types |= curPossibleArgumentValues;
+				if (isSingleArgType(curPossibleArgumentValues))
+				{
+					if (typeRank(curPossibleArgumentValues) > typeRank(typeSingle))
+					{
+						typeSingle = curPossibleArgumentValues;
+					}
+				}
+				else if (!typeVector || typeRank(typeVector) < typeRank(curPossibleArgumentValues))
+				{
+					typeVector = curPossibleArgumentValues;
+				}
+			}
+
+			// Vector elements and ARG_REAL are not wide enough, reading them would narrow
+			// the value. Other numbers can not be read as ARG_SIZE (64K) or the reverse (2.5).
+			const bool wide = (types & (ARG_INT64 | ARG_UINT64 | ARG_SIZE)) != 0;
+			if (wide && (typeVector || (types & ARG_REAL))) return UNEXISTED;
+			if ((types & ARG_SIZE) && (types & (ARG_INT | ARG_INT64 | ARG_UINT64))) return UNEXISTED;
+
+			return onlyFlags ? ARG_BOOL : getTypeToRead(typeSingle, typeVector);
+		}
+
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		class OptionValueString : public OptionValue
+		SCLAP_INLINE char listDelimiter(const ArgumentOptions& options)
 		{
-		public:
-			virtual const std::string asString() const { return mValue; };
+			for (size_t i = 0; i < options.size; ++i)
+			{
+				const char delimiter = options.descriptors[i]->listDelimiter();
+				if (delimiter != LIST_DELIMITER_NONE) return delimiter;
+			}
+			return LIST_DELIMITER_NONE;
+		}
 
-			virtual const std::vector<std::string> asStringVector() const
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE OptionValue* createValue(ArgType type, Arena* arena, bool copyStrings, char delimiter)
+		{
+			switch (type)
 			{
-				return std::vector<std::string>(1, asString());
+			case ARG_STRING: return create<OptionValueString>(arena, arena, copyStrings);
+			case ARG_BOOL: return create<OptionValueBool>(arena);
+			case ARG_INT: return create<OptionValueInt>(arena);
+			case ARG_REAL: return create<OptionValueReal>(arena);
+			case ARG_STRING_VEC: return create<OptionValueStringVector>(arena, arena, copyStrings, delimiter);
+			case ARG_BOOL_VEC: return create<OptionValueBoolVector>(arena, arena, delimiter);
+			case ARG_INT_VEC: return create<OptionValueIntVector>(arena, arena, delimiter);
+			case ARG_REAL_VEC: return create<OptionValueRealVector>(arena, arena, delimiter);
+			case ARG_INT64: return create<OptionValueInt64>(arena);
+			case ARG_UINT64: return create<OptionValueUInt64>(arena);
+			case ARG_SIZE: return create<OptionValueSize>(arena);
+			case ARG_FLOAT_VEC: return create<OptionValueFloatVector>(arena, arena, delimiter);
+			default: return NULL;
 			}
+		}
 
-			virtual uint8_t type() const { return ARG_STRING; }
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-			virtual bool read(int& inOutCurIndex,
-				char** inOutCurArgumentStr, int argc, char** inArgv)
+		// Takes the same arguments as read() of the type would, without converting.
+		SCLAP_INLINE bool OptionValueLazy::read(int& inOutCurIndex, char** inOutCurArgumentStr,
+			int argc, char** inArgv)
+		{
+			mArgv = inArgv;
+			mFirstIndex = inOutCurIndex;
+			mFirstArgumentStr = *inOutCurArgumentStr;
+
+			if (mType == ARG_BOOL)
 			{
-				if (inOutCurIndex >= argc)
+				// flags, the value is optional
+				if (inOutCurIndex < argc && (!strcmp(*inOutCurArgumentStr, "true")
+					|| !strcmp(*inOutCurArgumentStr, "false")))
 				{
-					return false;
+					++inOutCurIndex;
+					*inOutCurArgumentStr = inArgv[inOutCurIndex];
 				}
-				else
+			}
+			else if (isSingleArgType(mType))
+			{
+				if (inOutCurIndex >= argc || **inOutCurArgumentStr == '\0') return false;
+				++inOutCurIndex;
+				*inOutCurArgumentStr = inArgv[inOutCurIndex];
+			}
+			else if (isPackedList(*inOutCurArgumentStr, inOutCurIndex, argc, inArgv, mDelimiter))
+			{
+				++inOutCurIndex;
+				*inOutCurArgumentStr = inArgv[inOutCurIndex];
+			}
+			else
+			{
+				while (inOutCurIndex < argc
+					&& **inOutCurArgumentStr != '-'
+					&& **inOutCurArgumentStr != '\0')
 				{
-					return readString(inOutCurIndex, inOutCurArgumentStr, inArgv, mValue);
+					++inOutCurIndex;
+					*inOutCurArgumentStr = inArgv[inOutCurIndex];
 				}
+				if (inOutCurIndex == mFirstIndex) return false;
 			}
 
-		private:
-			std::string mValue;
-		};
+			mEndIndex = inOutCurIndex;
+			return true;
+		}
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
-		/*--------------------------------------------------------------------------------------------*/
 		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		class OptionValueBoolVector : public OptionValue
+		SCLAP_INLINE const OptionValue& OptionValueLazy::value() const
 		{
-		public:
-			virtual const std::string asString() const
+			if (!mConverted)
 			{
-				std::string valueStr = "";
-				for (size_t i = 0; i < mValue.size(); ++i)
+				mConverted = true;
+				mValue = createValue(mType, mArena, mCopyStrings, mDelimiter);
+
+				// the arguments must be read completely
+				int curIndex = mFirstIndex;
+				char* curArgumentStr = mFirstArgumentStr;
+				if (!mValue || !mValue->read(curIndex, &curArgumentStr, mEndIndex, mArgv)
+					|| curIndex != mEndIndex)
 				{
-					valueStr += mValue[i] ? "true" : "false";
-					valueStr += " ";
+					if (mValue) destroy(mArena, mValue);
+					mValue = NULL;
 				}
-
-				valueStr = valueStr.substr(1, valueStr.size() - 1);
-				return valueStr;
 			}
-			virtual const std::vector<std::string> asStringVector() const;
-			virtual bool asBool() const { return mValue[0]; }
-			virtual const std::vector<bool> asBoolVector() const { return mValue; }
-  
-			virtual uint8_t type() const { return ARG_BOOL_VEC; }
 
-			virtual bool read(int& inOutCurIndex,
-				char** inOutCurArgumentStr, int argc, char** inArgv);
+			if (mValue) return *mValue;
+			return unexisted();
+		}
+	}
 
-		private:
-			std::vector<bool> mValue;
-		};
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE const Option& Options::none()
+	{
+		static const Option option(OPT_SHORT_NONE, "", NULL);
+		return option;
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE const Option& Options::operator[](const std::string& opt) const
+	{
+		return find(opt.data(), opt.size());
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE const Option& Options::operator[](const char* opt) const
+	{
+		return find(opt, strlen(opt));
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE const Option& Options::operator[](char opt) const
+	{
+		const int i = mShortIndex[(unsigned char)opt];
+
+		return i == hidden::NameIndex::NONE ? none() : *mOptions[i];
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE const Option& Options::find(const char* opt, size_t size) const
+	{
+		if (size == 1) return operator[](opt[0]);
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		const hidden::OptionLongNameEqual equal = { mOptions.data() };
+		const int i = mLongIndex.find(opt, size, equal);
 
-		bool OptionValueBoolVector::read(int& inOutCurIndex, char** inOutCurArgumentStr,
-			int argc, char** inArgv)
-		{
-			int startIndex = inOutCurIndex;
-			char** startArgument = inOutCurArgumentStr;
+		return i == hidden::NameIndex::NONE ? none() : *mOptions[i];
+	}
 
-			mValue.clear();
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-			std::string strArg;
-			while (inOutCurIndex < argc 
-				&& **inOutCurArgumentStr != '-' 
-				&& **inOutCurArgumentStr != '\0')
-			{
-				if (readString(inOutCurIndex, inOutCurArgumentStr, inArgv, strArg))
-				{
-					if (strArg == "True" || strArg == "true")
-					{
-						mValue.push_back(true);
-					}
-					else if (strArg == "False" || strArg == "false")
-					{
-						mValue.push_back(false);
-					}
-					else
-					{
-						inOutCurArgumentStr = startArgument;
-						inOutCurIndex = startIndex;
-						return false;
-					}
-				}
-			}
+	SCLAP_INLINE void Options::index()
+	{
+		for (size_t i = 0; i < 256; ++i)
+		{
+			mShortIndex[i] = hidden::NameIndex::NONE;
+		}
 
-			return mValue.size() > 0;
+		for (size_t i = 0; i < mOptions.size(); ++i)
+		{
+			index(i);
 		}
+	}
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		const std::vector<std::string> OptionValueBoolVector::asStringVector() const
+	SCLAP_INLINE void Options::index(size_t option)
+	{
+		const char shortName = mOptions[option]->shortName();
+		if (shortName != OPT_SHORT_NONE && mShortIndex[(unsigned char)shortName] == hidden::NameIndex::NONE)
 		{
-			std::vector<std::string> ret(mValue.size());
-			for (size_t i = 0; i < mValue.size(); ++i)
-			{
-				ret[i] = mValue[i] ? "true" : "false";
-			}
+			mShortIndex[(unsigned char)shortName] = (int)option;
+		}
 
-			return ret;
+		const StringView longName = mOptions[option]->longNameView();
+		if (longName.size())
+		{
+			const hidden::OptionLongNameEqual equal = { mOptions.data() };
+			mLongIndex.insert(longName.data(), longName.size(), (int)option, equal);
 		}
+	}
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
-		/*--------------------------------------------------------------------------------------------*/
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		class OptionValueIntVector : public OptionValue
+	// Only the variables of the descriptors with an environment name are looked up, one
+	// getenv each and only for options not given in argv, so the rest of the environment
+	// is never scanned or copied. The value of a variable is read like the only argument
+	// of a command line, right away also with PARSE_LAZY, and always copied, as the
+	// environment may change later.
+	SCLAP_INLINE void Options::readEnvironment()
+	{
+		const size_t count = mDescriptors.environmentSize();
+		for (size_t i = 0; i < count; ++i)
 		{
-		public:
-			virtual const std::string asString() const { return hidden::numberToString(mValue[0]); };
-			virtual double asReal() const { return mValue[0]; };
-			virtual int asInteger() const { return mValue[0]; };
-			virtual bool asBool() const { return mValue[0]; };
+			const DescriptorView& desc = mDescriptors.environmentDescriptor(i);
+			const Option& given = desc.longNameSize() ? find(desc.longNameView().data(), desc.longNameSize())
+				: operator[](desc.shortName());
+			if (&given != &none()) continue;
 
-			virtual const std::vector<std::string> asStringVector() const;
-			virtual const std::vector<double> asRealVector() const
-			{
-				return std::vector<double>(mValue.begin(), mValue.end());
-			}
-			virtual const std::vector<int> asIntegerVector() const
-			{ 
-				return mValue;
-			}
-			virtual const std::vector<bool> asBoolVector() const
+			char* variable = getenv(desc.environmentName());
+			if (!variable) continue;
+
+			const size_t size = strlen(desc.environmentName());
+			char* arguments[] = { variable, NULL };
+			if (desc.possibleArgumentValues() == ARG_BOOL)
 			{
-				return std::vector<bool>(mValue.begin(), mValue.end());
+				// usual values of boolean variables, the bool value does not keep the string
+				if (!strcmp(arguments[0], "1")) arguments[0] = (char*)"true";
+				else if (!strcmp(arguments[0], "0")) arguments[0] = (char*)"false";
 			}
+			int curIndex = 0;
+			char* curArgumentStr = arguments[0];
 
-			virtual uint8_t type() const { return ARG_INT_VEC; }
-
-			virtual bool read(int& inOutCurIndex,
-				char** inOutCurArgumentStr, int argc, char** inArgv);
-
-		private:
-			std::vector<int> mValue;
-		};
-
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+			OptionValue* value = hidden::createValue(desc.possibleArgumentValues(), mArena, true,
+				desc.listDelimiter());
+			if (!value) continue;
 
-		const std::vector<std::string> OptionValueIntVector::asStringVector() const
-		{
-			std::vector<std::string> ret(mValue.size());
-			for (size_t i = 0; i < mValue.size(); ++i)
+			mOptionValues.push_back(value);
+			if (!value->read(curIndex, &curArgumentStr, 1, arguments) || curIndex != 1)
 			{
-				ret[i] = hidden::numberToString(mValue[i]);
+				mOk = false;
+				// only the name, the value may be a secret
+				mErrors.push_back(hidden::makeError(ERROR_ENVIRONMENT, desc.environmentName(), size, -1, 0));
+				return;
 			}
 
-			return ret;
+			mOptions.push_back(hidden::create<Option>(mArena, desc.shortName(), desc.longNameView().data(), value));
+			index(mOptions.size() - 1);
 		}
+	}
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		bool OptionValueIntVector::read(int& inOutCurIndex, char** inOutCurArgumentStr,
-			int argc, char** inArgv)
+	SCLAP_INLINE bool Options::readConfigFile(const char* path)
+	{
+		hidden::MappedFile* file = hidden::create<hidden::MappedFile>(mArena);
+		mFiles.push_back(file);
+		if (!file->open(path))
 		{
-			int startIndex = inOutCurIndex;
-			char** startArgument = inOutCurArgumentStr;
+			mOk = false;
+			mErrors.push_back(hidden::makeError(ERROR_CONFIG_FILE, path, strlen(path), -1, 0));
+			return false;
+		}
 
-			mValue.clear();
+		// tokens of one value, reused for all lines
+		hidden::Buffer<char*> arguments(mArena);
 
-			int intArg;
-			while (inOutCurIndex < argc
-				&& **inOutCurArgumentStr != '-'
-				&& **inOutCurArgumentStr != '\0')
+		char* cur = file->data();
+		char* const end = cur + file->size();
+		for (int number = 1; cur < end; ++number)
+		{
+			char* lineEnd = (char*)memchr(cur, '\n', end - cur);
+			if (!lineEnd) lineEnd = end;
+
+			if (!readConfigLine(cur, lineEnd, number, arguments))
 			{
-				if (readInt(inOutCurIndex, inOutCurArgumentStr, inArgv, intArg))
-				{
-					mValue.push_back(intArg);
-				} 
-				else
-				{
-					inOutCurIndex = startIndex;
-					inOutCurArgumentStr = startArgument;
-					return false;
-				}
+				mOk = false;
+				return false;
 			}
-
-			return mValue.size() > 0;
+			cur = lineEnd + 1;
 		}
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
-		/*--------------------------------------------------------------------------------------------*/
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		return true;
+	}
 
-		class OptionValueRealVector : public OptionValue
-		{
-		public:
-			virtual const std::string asString() const { return hidden::numberToString(mValue[0]); };
-			virtual double asReal() const { return mValue[0]; };
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-			virtual const std::vector<std::string> asStringVector() const;
-			virtual const std::vector<double> asRealVector() const { return mValue; }
+	// The line is terminated in place after the value (*end is writable). Values are
+	// read right away also with PARSE_LAZY, as the arguments are reused. Errors name
+	// the option, or hold the line when it has none.
+	SCLAP_INLINE bool Options::readConfigLine(char* line, char* end, int number,
+		hidden::Buffer<char*>& arguments)
+	{
+		while (end != line && hidden::isSpace(end[-1])) --end;
+		*end = '\0';
 
-			virtual uint8_t type() const { return ARG_REAL_VEC; }
+		while (line != end && hidden::isSpace(*line)) ++line;
+		if (line == end || *line == '#') return true;
 
-			virtual bool read(int& inOutCurIndex,
-				char** inOutCurArgumentStr, int argc, char** inArgv);
+		char* separator = (char*)memchr(line, '=', end - line);
+		if (!separator)
+		{
+			mErrors.push_back(hidden::makeError(ERROR_CONFIG_LINE, line, end - line, number, 0));
+			return false;
+		}
 
-		private:
-			std::vector<double> mValue;
-		};
+		char* nameEnd = separator;
+		while (nameEnd != line && hidden::isSpace(nameEnd[-1])) --nameEnd;
+		char* value = separator + 1;
+		while (value != end && hidden::isSpace(*value)) ++value;
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		const DescriptorView* desc = mDescriptors.findLong(line, nameEnd - line);
+		if (!desc)
+		{
+			mErrors.push_back(hidden::makeError(ERROR_CONFIG_LINE, line, nameEnd - line, number, 0));
+			return false;
+		}
+		if (&find(desc->longNameView().data(), desc->longNameSize()) != &none()) return true;
 
-		const std::vector<std::string> OptionValueRealVector::asStringVector() const
+		const ArgType type = desc->possibleArgumentValues();
+		arguments.clear();
+		if (!hidden::isSingleArgType(type) && desc->listDelimiter() == LIST_DELIMITER_NONE)
 		{
-			std::vector<std::string> ret(mValue.size());
-			for (size_t i = 0; i < mValue.size(); ++i)
+			while (char* token = hidden::nextToken(value, end))
 			{
-				ret[i] = hidden::numberToString(mValue[i]);
+				arguments.push_back(token);
 			}
-
-			return ret;
 		}
+		else if (value != end)
+		{
+			arguments.push_back(value);
+		}
+		const int argc = (int)arguments.size();
+		arguments.push_back(NULL);
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		OptionValue* optionValue = hidden::createValue(type, mArena, !(mFlags & PARSE_ZERO_COPY),
+			desc->listDelimiter());
+		if (!optionValue) return true;
+		mOptionValues.push_back(optionValue);
 
-		bool OptionValueRealVector::read(int& inOutCurIndex, char** inOutCurArgumentStr,
-			int argc, char** inArgv)
+		int curIndex = 0;
+		char* curArgumentStr = arguments[0];
+		if (!optionValue->read(curIndex, &curArgumentStr, argc, arguments.data()) || curIndex != argc)
 		{
-			int startIndex = inOutCurIndex;
-			char** startArgument = inOutCurArgumentStr;
+			const size_t offset = argc ? arguments[curIndex < argc ? curIndex : 0] - line : 0;
+			mErrors.push_back(hidden::makeError(ERROR_CONFIG_LINE, line, nameEnd - line, number, offset));
+			return false;
+		}
 
-			mValue.clear();
+		mOptions.push_back(hidden::create<Option>(mArena, desc->shortName(), desc->longNameView().data(), optionValue));
+		index(mOptions.size() - 1);
+		return true;
+	}
 
-			double doubleArg;
-			while (inOutCurIndex < argc
-				&& **inOutCurArgumentStr != '-'
-				&& **inOutCurArgumentStr != '\0')
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	// Response files are not expanded recursively, @ inside of them is literal.
+	SCLAP_INLINE bool Options::expandResponseFiles(int argc, char** argv)
+	{
+		for (int i = 0; i < argc; ++i)
+		{
+			if (i == 0 || argv[i][0] != '@')
 			{
-				if (readDouble(inOutCurIndex, inOutCurArgumentStr, inArgv, doubleArg))
-				{
-					mValue.push_back(doubleArg);
-				}
+				mArguments.push_back(argv[i]);
+				continue;
 			}
 
-			return mValue.size() > 0;
+			hidden::MappedFile* file = hidden::create<hidden::MappedFile>(mArena);
+			mFiles.push_back(file);
+			if (!file->open(argv[i] + 1))
+			{
+				mOk = false;
+				mErrors.push_back(hidden::makeError(ERROR_RESPONSE_FILE, argv[i] + 1,
+					strlen(argv[i] + 1), i, 1));
+				return false;
+			}
+
+			char* cur = file->data();
+			char* end = cur + file->size();
+			while (char* token = hidden::nextToken(cur, end))
+			{
+				mArguments.push_back(token);
+			}
 		}
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
-		/*--------------------------------------------------------------------------------------------*/
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		mArguments.push_back(NULL);
+		return true;
+	}
 
-		class OptionValueStringVector : public OptionValue
-		{
-		public:
-			virtual const std::string asString() const { return mValue[0]; };
-			virtual const std::vector<std::string> asStringVector() const { return mValue; }
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-			virtual uint8_t type() const { return ARG_STRING_VEC; }
+	SCLAP_INLINE void Options::parse(int argc, char** argv)
+	{
+		SCLAP_STAT(hidden::StatScope statScope(mStats));
+		SCLAP_STAT(hidden::PhaseClock clock);
 
-			virtual bool read(int& inOutCurIndex,
-				char** inOutCurArgumentStr, int argc, char** inArgv);
+		if ((mFlags & PARSE_RESPONSE_FILES) && argc > 1)
+		{
+			if (!expandResponseFiles(argc, argv)) return;
 
-		private:
-			std::vector<std::string> mValue;
-		};
+			argc = (int)mArguments.size() - 1;
+			argv = mArguments.data();
+		}
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+		int curIndex = 1;
+		char* curArgumentStr = argv[curIndex];
 
-		bool OptionValueStringVector::read(int& inOutCurIndex, char** inOutCurArgumentStr,
-			int argc, char** inArgv)
+		hidden::ArgumentOptions argumentOptions;
+		while (curIndex < argc)
 		{
-			int startIndex = inOutCurIndex;
-			char** startArgument = inOutCurArgumentStr;
+			const int optionIndex = curIndex;
+			Error error;
+			if (!hidden::readOptionNames(mDescriptors, curIndex, &curArgumentStr, argv,
+				argumentOptions, error))
+			{
+				mOk = false;
+				mErrors.push_back(error);
+				mErrors.insert(mErrors.end(), mDescriptors.errors().begin(), mDescriptors.errors().end());
+				break;
+			}
+			SCLAP_STAT(clock.lap(&ParseStats::nameTime));
+			SCLAP_STAT(++mStats.arguments);
+			SCLAP_STAT(mStats.clusters += argumentOptions.size > 1);
+
+			const ArgType argumentValues = hidden::valueType(argumentOptions);
+			const char delimiter = hidden::listDelimiter(argumentOptions);
+			SCLAP_STAT(clock.lap(&ParseStats::typeTime));
+			if (argumentValues == UNEXISTED)
+			{
+				mOk = false;
+				mErrors.push_back(hidden::makeError(ERROR_WIDE_SHARED_ARGUMENT, argv[optionIndex],
+					strlen(argv[optionIndex]), optionIndex, 0));
+				return;
+			}
 
-			mValue.clear();
+			const bool copyStrings = !(mFlags & PARSE_ZERO_COPY);
+			OptionValue* value = (mFlags & PARSE_LAZY)
+				? hidden::create<hidden::OptionValueLazy>(mArena, argumentValues, delimiter, mArena, copyStrings)
+				: hidden::createValue(argumentValues, mArena, copyStrings, delimiter);
+			if (!value)
+			{
+				// all types are known
+				exit(-1);
+			}
+			mOptionValues.push_back(value);
 
-			std::string strArg;
-			while (inOutCurIndex < argc
-				&& **inOutCurArgumentStr != '-'
-				&& **inOutCurArgumentStr != '\0')
+			const int valueIndex = curIndex;
+			const char* valueStr = curArgumentStr;
+			if (!mOptionValues.back()->read(curIndex, &curArgumentStr, argc, argv))
 			{
-				if (readString(inOutCurIndex, inOutCurArgumentStr, inArgv, strArg))
-				{
-					mValue.push_back(strArg);
-				}
+				mOk = false;
+				// the option itself when the value is missing
+				const int index = valueIndex < argc ? valueIndex : optionIndex;
+				const char* subject = valueIndex < argc ? valueStr : argv[optionIndex];
+				mErrors.push_back(hidden::makeError(ERROR_READ_ARGUMENT, subject, strlen(subject),
+					index, subject - argv[index]));
+				return;
 			}
-			return mValue.size() > 0;
-		}
 
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
-		/*--------------------------------------------------------------------------------------------*/
-		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+			for (size_t i = 0; i < argumentOptions.size; ++i)
+			{
+				const DescriptorView* desc = argumentOptions.descriptors[i];
+				mOptions.push_back(hidden::create<Option>(mArena, desc->shortName(),
+					desc->longNameView().data(), mOptionValues.back()));
+			}
+			SCLAP_STAT(clock.lap(&ParseStats::readTime));
+			SCLAP_STAT(mStats.tokens += curIndex - optionIndex);
+		}
 	}
 
-	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
-	/*------------------------------------------------------------------------------------------------*/
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-	// Base class for options with different type of arguments defined in private namespace.
-	// Provides basic functionality and interface.
-	class Option
+	SCLAP_INLINE std::vector<char> Options::serialize() const
 	{
-	public:
-		Option(const char shortName, const std::string longName, OptionValue* value)
-			: mShortName(shortName), mLongName(longName), mValue(value)
+		// tables are written last, the vector moves while it grows
+		const uint32_t slotCount = (uint32_t)hidden::nextPowerOfTwo(std::max<size_t>(16, mOptions.size() * 2));
+		std::vector<char> data(sizeof(hidden::SerializedHeader) + slotCount * sizeof(hidden::SerializedSlot)
+			+ mOptions.size() * sizeof(hidden::SerializedOption));
+
+		std::vector<hidden::SerializedOption> records(mOptions.size());
+		std::vector<hidden::SerializedString> strings;
+		for (size_t i = 0; i < mOptions.size(); ++i)
 		{
-			if (!value)
+			const Option& option = *mOptions[i];
+			hidden::SerializedOption& record = records[i];
+			memset(&record, 0, sizeof(record));
+
+			const StringView name = option.longNameView();
+			record.name = hidden::appendAligned(data, name.data(), name.size() + 1);
+			record.nameSize = name.size();
+			record.type = option.type();
+			record.shortName = option.shortName();
+			record.valid = option.valid();
+			record.count = 1;
+
+			switch (record.valid ? option.type() : UNEXISTED)
+			{
+			case ARG_BOOL:
+			{
+				const bool value = option.asBool();
+				record.elements = hidden::appendAligned(data, &value, sizeof(value));
+				break;
+			}
+			case ARG_INT:
+			{
+				const int value = option.asInteger();
+				record.elements = hidden::appendAligned(data, &value, sizeof(value));
+				break;
+			}
+			case ARG_REAL:
+			{
+				const double value = option.asDouble();
+				record.elements = hidden::appendAligned(data, &value, sizeof(value));
+				break;
+			}
+			case ARG_INT64:
+			{
+				const int64_t value = option.asInt64();
+				record.elements = hidden::appendAligned(data, &value, sizeof(value));
+				break;
+			}
+			case ARG_UINT64:
+			case ARG_SIZE:
+			{
+				const uint64_t value = option.asUInt64();
+				record.elements = hidden::appendAligned(data, &value, sizeof(value));
+				break;
+			}
+			case ARG_BOOL_VEC:
+			{
+				const Span<bool> values = option.asBoolSpan();
+				record.elements = hidden::appendAligned(data, values.data(), values.size() * sizeof(bool));
+				record.count = values.size();
+				break;
+			}
+			case ARG_INT_VEC:
+			{
+				const Span<int> values = option.asIntegerSpan();
+				record.elements = hidden::appendAligned(data, values.data(), values.size() * sizeof(int));
+				record.count = values.size();
+				break;
+			}
+			case ARG_REAL_VEC:
+			{
+				const Span<double> values = option.asRealSpan();
+				record.elements = hidden::appendAligned(data, values.data(), values.size() * sizeof(double));
+				record.count = values.size();
+				break;
+			}
+			case ARG_FLOAT_VEC:
+			{
+				const Span<float> values = option.asFloatSpan();
+				record.elements = hidden::appendAligned(data, values.data(), values.size() * sizeof(float));
+				record.count = values.size();
+				break;
+			}
+			case ARG_STRING:
+			case ARG_STRING_VEC:
 			{
-				mValue = &sOptionNone;
+				const Span<StringView> values = option.type() == ARG_STRING
+					? Span<StringView>(NULL, 0) : option.asStringViews();
+				const StringView single = option.asStringView();
+				const size_t count = option.type() == ARG_STRING ? 1 : values.size();
+
+				strings.resize(count);
+				for (size_t j = 0; j < count; ++j)
+				{
+					const StringView value = option.type() == ARG_STRING ? single : values[j];
+					strings[j].offset = hidden::appendAligned(data, value.data(), value.size());
+					strings[j].size = value.size();
+					data.push_back('\0');
+				}
+				record.elements = hidden::appendAligned(data, strings.data(),
+					count * sizeof(hidden::SerializedString));
+				record.count = count;
+				break;
+			}
+			default:
+				record.count = 0;
+				break;
 			}
 		}
 
-		virtual ~Option() {}
-
-		const char shortName() const
+		hidden::SerializedHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, hidden::SERIALIZED_MAGIC, sizeof(header.magic));
+		header.version = hidden::SERIALIZED_VERSION;
+		header.options = (uint32_t)mOptions.size();
+		header.slots = slotCount;
+		header.size = data.size();
+		for (size_t i = 0; i < 256; ++i)
 		{
-			return mShortName;
+			header.shortIndex[i] = mShortIndex[i];
 		}
+		memcpy(data.data(), &header, sizeof(header));
 
-		const std::string longName() const
+		// same first wins order as mLongIndex
+		hidden::SerializedSlot* slots = (hidden::SerializedSlot*)(data.data() + sizeof(header));
+		for (size_t i = 0; i < slotCount; ++i)
 		{
-			return mLongName;
+			slots[i].hash = 0;
+			slots[i].option = hidden::NameIndex::NONE;
+		}
+		const hidden::OptionLongNameEqual equal = { mOptions.data() };
+		for (size_t i = 0; i < mOptions.size(); ++i)
+		{
+			const StringView name = mOptions[i]->longNameView();
+			if (!name.size() || mLongIndex.find(name.data(), name.size(), equal) != (int)i) continue;
+
+			const uint32_t hash = hidden::hashName(name.data(), name.size());
+			size_t slot = hash & (slotCount - 1);
+			while (slots[slot].option != hidden::NameIndex::NONE) slot = (slot + 1) & (slotCount - 1);
+			slots[slot].hash = hash;
+			slots[slot].option = (int32_t)i;
 		}
 
-		uint8_t type() const { return mValue->type(); }
-		bool asBool() const { return mValue->asBool(); }
-		const std::vector<bool> asBoolVector() const { return mValue->asBoolVector(); }
-		int asInteger() const { return mValue->asInteger(); }
-		const std::vector<int> asIntegerVector() const { return mValue->asIntegerVector(); }
-		double asDouble() const { return mValue->asReal(); }
-		const std::vector<double> asRealVector() const { return mValue->asRealVector(); }
-		const std::string asString() const { return mValue->asString(); }
-		const std::vector<std::string> asStringVector() const { return mValue->asStringVector(); }
-		operator bool() const { return asBool(); }
+		if (!records.empty())
+		{
+			memcpy(slots + slotCount, records.data(), records.size() * sizeof(hidden::SerializedOption));
+		}
+		return data;
+	}
 
-	private:
-		static hidden::OptionValueUnexisted sOptionNone;
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		const char mShortName;
-		const std::string mLongName;
-		OptionValue* mValue;
-	};
+	SCLAP_INLINE bool Options::serialize(const char* path) const
+	{
+		const std::vector<char> data = serialize();
 
-	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+		FILE* file = fopen(path, "wb");
+		if (!file) return false;
 
-	hidden::OptionValueUnexisted Option::sOptionNone = hidden::OptionValueUnexisted();
+		const bool res = fwrite(data.data(), 1, data.size(), file) == data.size();
+		return fclose(file) == 0 && res;
+	}
 
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 	/*------------------------------------------------------------------------------------------------*/
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-	class Options
+	namespace hidden
 	{
-	public:
-		Options(OptionDescriptors& descriptors, int argc, char** argv)
-			: mDescriptors(descriptors)
+		SCLAP_INLINE uint64_t appendAligned(std::vector<char>& data, const void* bytes, size_t size)
 		{
-			if (mDescriptors.valid())
-			{
-				mOk = true;
-				parse(argc, argv);
-			}
+			data.resize((data.size() + 7) & ~(size_t)7);
+
+			const uint64_t offset = data.size();
+			data.insert(data.end(), (const char*)bytes, (const char*)bytes + size);
+			return offset;
 		}
 
-		~Options()
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE size_t serializedElementSize(ArgType type)
 		{
-			for (size_t i = 0; i < mOptions.size(); ++i)
-			{
-				delete mOptions[i];
-			}
-			for (size_t i = 0; i < mOptionValues.size(); ++i)
+			switch (type)
 			{
-				delete mOptionValues[i];
+			case ARG_BOOL:
+			case ARG_BOOL_VEC: return sizeof(bool);
+			case ARG_INT:
+			case ARG_INT_VEC: return sizeof(int);
+			case ARG_REAL:
+			case ARG_REAL_VEC: return sizeof(double);
+			case ARG_FLOAT_VEC: return sizeof(float);
+			case ARG_INT64: return sizeof(int64_t);
+			case ARG_UINT64:
+			case ARG_SIZE: return sizeof(uint64_t);
+			case ARG_STRING:
+			case ARG_STRING_VEC: return sizeof(SerializedString);
+			default: return 0;
 			}
 		}
 
-		bool valid() const { return mOk; }
-		std::string error() const { return mError.str(); }
-
-		const Option& operator[](std::string option) const;
-		const Option& operator[](char option) const;
-
-	private:
-		static Option sOptionNone;
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		OptionDescriptors mDescriptors;
-		
-		std::vector<Option*> mOptions;
-		std::vector<OptionValue*> mOptionValues;
+		SCLAP_INLINE bool validSerializedOption(const char* data, uint64_t size, const SerializedOption& option)
+		{
+			// valid scalars have exactly one element, invalid options none
+			const size_t elementSize = serializedElementSize(option.type);
+			if (!elementSize || option.valid > 1 || (!option.valid && option.count)
+				|| (option.valid && isSingleArgType(option.type) && option.count != 1)
+				|| option.name > size || option.nameSize >= size - option.name
+				|| option.elements % 8 || option.elements > size
+				|| option.count > (size - option.elements) / elementSize)
+			{
+				return false;
+			}
 
-		std::stringstream mError;
-		bool mOk;
+			if (option.type != ARG_STRING && option.type != ARG_STRING_VEC) return true;
 
-		void parse(int argc, char** argv);
-		bool readOptionNames(int& inOutCurIndex, char** inOutCurArgumentStr,
-			char** inArgv, std::set<std::string>& outOptions);
-	};
+			const SerializedString* strings = (const SerializedString*)(data + option.elements);
+			for (uint64_t i = 0; i < option.count; ++i)
+			{
+				if (strings[i].offset > size || strings[i].size >= size - strings[i].offset) return false;
+			}
+			return true;
+		}
+	}
 
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-	Option Options::sOptionNone = Option(OPT_SHORT_NONE, "", NULL);
+	SCLAP_INLINE std::string OptionView::elementString(size_t i) const
+	{
+		switch (type())
+		{
+		case ARG_STRING:
+		case ARG_STRING_VEC: return std::string(asStringView(i).data(), asStringView(i).size());
+		case ARG_BOOL:
+		case ARG_BOOL_VEC: return elements<bool>()[i] ? "true" : "false";
+		case ARG_INT:
+		case ARG_INT_VEC: return hidden::numberToString(elements<int>()[i]);
+		case ARG_REAL:
+		case ARG_REAL_VEC: return hidden::numberToString(elements<double>()[i]);
+		case ARG_FLOAT_VEC: return hidden::numberToString(elements<float>()[i]);
+		case ARG_INT64: return hidden::numberToString(elements<int64_t>()[i]);
+		case ARG_UINT64:
+		case ARG_SIZE: return hidden::numberToString(elements<uint64_t>()[i]);
+		default: return "";
+		}
+	}
 
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-	// extract long option (--long --> { "long" }) 
-	// or set (or single) of short options (-short --> { "s", "h", "o", "r", "t" })
-	bool Options::readOptionNames(int& inOutCurIndex, char** inOutCurArgumentStr,
-		char** inArgv, std::set<std::string>& outOptionNames)
+	SCLAP_INLINE const std::vector<std::string> OptionView::asStringVector() const
 	{
-        char *startArgumentStr = *inOutCurArgumentStr;
-
-		if (**inOutCurArgumentStr == '-')
+		std::vector<std::string> ret(size());
+		for (size_t i = 0; i < ret.size(); ++i)
 		{
-			++* inOutCurArgumentStr;
-			// -- (long option)
-			if (**inOutCurArgumentStr == '-')
-			{
-				++* inOutCurArgumentStr;
-				std::string optionName;
+			ret[i] = elementString(i);
+		}
+		return ret;
+	}
 
-				while ((**inOutCurArgumentStr != '=') && (**inOutCurArgumentStr != '\0'))
-				{
-					optionName.push_back(*(*inOutCurArgumentStr)++);
-				}
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-				if (**inOutCurArgumentStr == '\0')
-				{
-					++inOutCurIndex;
-					*inOutCurArgumentStr = inArgv[inOutCurIndex];
-				}
-				else if (**inOutCurArgumentStr == '=')
-				{
-					++* inOutCurArgumentStr;
-				}
+	SCLAP_INLINE StringView OptionView::asStringView(size_t i) const
+	{
+		if (!isString() || i >= size()) return StringView();
 
-				if (mDescriptors[optionName])
-				{
-					outOptionNames.insert(optionName);
-				}
-				else
-				{
-                    mOk = false;
-                    --inOutCurIndex;
-                    *inOutCurArgumentStr = startArgumentStr;
+		const hidden::SerializedString& string = elements<hidden::SerializedString>()[i];
+		return StringView(mData + string.offset, (size_t)string.size);
+	}
 
-                    if (optionName.size())
-                    {
-                        mError << "Error: " << optionName << ". Is not an option.\n";
-					}
-                    else
-                    {
-                        mError << "Error: " << inArgv[inOutCurIndex] << ". Zero length option.\n";
-					}
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-					return false;
-				}
-			}
-			// - (short option(s))
-			else
-			{
-				while ((**inOutCurArgumentStr != '=') && (**inOutCurArgumentStr != '\0'))
-				{
-					std::string opt(1, **inOutCurArgumentStr);
-					if (outOptionNames.find(opt) == outOptionNames.end())
-					{
-						if (!mDescriptors[opt])
-						{
-							mOk = false;
-							mError << "Error: " << opt << " is not existing option.\n";
-							return false;
-						}
-						outOptionNames.insert(opt);
-						++(*inOutCurArgumentStr);
-					}
-					else
-					{
-						mOk = false;
-						mError << "Error: " << opt << ". Same option multiple times.\n";
-						return false;
-					}
-				}
+	// Every index and offset is checked once, so lookups and accessors stay within the data
+	// and find() always reaches an empty slot.
+	SCLAP_INLINE bool OptionsView::open(const void* data, size_t size)
+	{
+		mData = NULL;
+
+		const hidden::SerializedHeader* header = (const hidden::SerializedHeader*)data;
+		if (!data || (uintptr_t)data % 8 || size < sizeof(*header)
+			|| memcmp(header->magic, hidden::SERIALIZED_MAGIC, sizeof(header->magic))
+			|| header->version != hidden::SERIALIZED_VERSION || header->size > size
+			|| !header->slots || (header->slots & (header->slots - 1))
+			|| header->size < sizeof(*header) + header->slots * sizeof(hidden::SerializedSlot)
+				+ (uint64_t)header->options * sizeof(hidden::SerializedOption))
+		{
+			return false;
+		}
 
-				if (**inOutCurArgumentStr == '\0')
-				{
-					++inOutCurIndex;
-					*inOutCurArgumentStr = inArgv[inOutCurIndex];
-				}
-				else if (**inOutCurArgumentStr == '=')
-				{
-					++* inOutCurArgumentStr;
-				}
-			}
+		const int32_t options = (int32_t)header->options;
+		if (options < 0) return false;
+		for (size_t i = 0; i < 256; ++i)
+		{
+			const int32_t option = header->shortIndex[i];
+			if (option != hidden::NameIndex::NONE && (option < 0 || option >= options)) return false;
 		}
-		// not option
-		else
+
+		const hidden::SerializedSlot* slots = (const hidden::SerializedSlot*)(header + 1);
+		bool emptySlot = false;
+		for (size_t i = 0; i < header->slots; ++i)
 		{
-			mOk = false;
-			mError << "Error: " << *inOutCurArgumentStr << ". Option expected.\n";
-			return false;
+			const int32_t option = slots[i].option;
+			if (option == hidden::NameIndex::NONE) emptySlot = true;
+			else if (option < 0 || option >= options) return false;
+		}
+		if (!emptySlot) return false;
+
+		const hidden::SerializedOption* records = (const hidden::SerializedOption*)(slots + header->slots);
+		for (int32_t i = 0; i < options; ++i)
+		{
+			if (!hidden::validSerializedOption((const char*)data, header->size, records[i])) return false;
 		}
 
+		mData = (const char*)data;
 		return true;
 	}
 
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-	const Option& Options::operator[](std::string opt) const
+	SCLAP_INLINE bool OptionsView::open(const char* path)
 	{
-		if (opt.size() == 1) return operator[](opt[0]);
+		mData = NULL;
+		return mFile.open(path) && open(mFile.data(), mFile.size());
+	}
 
-		for (size_t i = 0; i < mOptions.size(); ++i)
-		{
-			if (mOptions[i]->longName() == opt)
-			{
-				return *mOptions[i];
-			}
-		}
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		return sOptionNone;
+	SCLAP_INLINE OptionView OptionsView::operator[](char opt) const
+	{
+		if (!valid()) return OptionView();
+
+		const int i = header().shortIndex[(unsigned char)opt];
+		return i == hidden::NameIndex::NONE ? OptionView() : OptionView(mData, &options()[i]);
 	}
 
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-	const Option& Options::operator[](char opt) const
+	SCLAP_INLINE OptionView OptionsView::find(const char* opt, size_t size) const
 	{
-		for (size_t i = 0; i < mOptions.size(); ++i)
+		if (size == 1) return operator[](opt[0]);
+		if (!valid()) return OptionView();
+
+		const uint32_t hash = hidden::hashName(opt, size);
+		const size_t mask = header().slots - 1;
+		for (size_t i = hash & mask; slots()[i].option != hidden::NameIndex::NONE; i = (i + 1) & mask)
 		{
-			if (mOptions[i]->shortName() == opt)
+			const hidden::SerializedOption& option = options()[slots()[i].option];
+			if (slots()[i].hash == hash && option.nameSize == size && !memcmp(mData + option.name, opt, size))
 			{
-				return *mOptions[i];
+				return OptionView(mData, &option);
 			}
 		}
 
-		return sOptionNone;
+		return OptionView();
 	}
 
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+	/*------------------------------------------------------------------------------------------------*/
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
-	void Options::parse(int argc, char** argv)
+	namespace hidden
 	{
-		int curIndex = 1;
-		char* curArgumentStr = argv[curIndex];
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-		while (curIndex < argc)
+		SCLAP_INLINE bool visitElement(VisitContext& context, ArgType type, int& inOutCurIndex,
+			char** inOutCurArgumentStr, char** inArgv)
 		{
-			std::set<std::string> optionNames;
-			if (!readOptionNames(curIndex, &curArgumentStr, argv, optionNames))
+			switch (type)
 			{
-				mOk = false;
-				mError << mDescriptors.error();
-				break;
+			case ARG_BOOL:
+			{
+				StringView value;
+				if (!readString(inOutCurIndex, inOutCurArgumentStr, inArgv, value)) return false;
+				if (value == "True" || value == "true") return context.visit(true);
+				if (value == "False" || value == "false") return context.visit(false);
+				return false;
+			}
+			case ARG_INT:
+			{
+				int value;
+				return readInt(inOutCurIndex, inOutCurArgumentStr, inArgv, value)
+					&& context.visit(value);
+			}
+			case ARG_REAL:
+			{
+				double value;
+				return readDouble(inOutCurIndex, inOutCurArgumentStr, inArgv, value)
+					&& context.visit(value);
+			}
+			case ARG_FLOAT_VEC:
+			{
+				double value;
+				return readWith(toFloatRange, inOutCurIndex, inOutCurArgumentStr, inArgv, value)
+					&& context.visit(value);
+			}
+			case ARG_INT64:
+			{
+				int64_t value;
+				return readWith(toInteger64, inOutCurIndex, inOutCurArgumentStr, inArgv, value)
+					&& context.visit(value);
+			}
+			case ARG_UINT64:
+			case ARG_SIZE:
+			{
+				uint64_t value;
+				return readWith(type == ARG_SIZE ? toSize : toUnsigned64,
+					inOutCurIndex, inOutCurArgumentStr, inArgv, value) && context.visit(value);
+			}
+			default:
+			{
+				StringView value;
+				return readString(inOutCurIndex, inOutCurArgumentStr, inArgv, value)
+					&& context.visit(value);
+			}
 			}
+		}
 
-			bool optionsExist = true;
-			bool onlyFlags = true;
-			uint8_t typeVector = 0;
-			uint8_t typeSingle = 1;
-			for (std::set<std::string>::const_iterator it = optionNames.begin();
-				it != optionNames.end();
-				++it)
-			{
-				const OptionDescriptor* desc = mDescriptors[*it];
-				if (desc == NULL)
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
+
+		SCLAP_INLINE bool visitPackedList(VisitContext& context, ArgType type, const char* list, char delimiter)
+		{
+			size_t rangeValues = 0;
+			StringView element;
+			while (nextListElement(list, delimiter, element))
+			{
+				bool res = false;
+				switch (type)
+				{
+				case ARG_BOOL:
 				{
-					optionsExist = false;
-					mOk = false;
-					mError << "Undefined option: " << *it << '\n';
+					bool value;
+					res = toElement(element, value) && context.visit(value);
 					break;
 				}
-
-				const uint8_t curPossibleArgumentValues = desc->possibleArgumentValues();
-				onlyFlags = onlyFlags && (curPossibleArgumentValues == ARG_BOOL);
-				if (hidden::isSingleArgType(curPossibleArgumentValues))
+				case ARG_INT:
 				{
-					if (curPossibleArgumentValues > typeSingle)
+					int first, last;
+					res = toRange(element, first, last) && countRange(rangeValues, first, last);
+					for (int64_t value = first; res && value <= last; ++value)
 					{
-						typeSingle = curPossibleArgumentValues;
+						res = context.visit((int)value);
 					}
+					break;
 				}
-				else if (typeVector < curPossibleArgumentValues)
+				case ARG_REAL:
 				{
-					typeVector = curPossibleArgumentValues;
+					double value;
+					res = toElement(element, value) && context.visit(value);
+					break;
+				}
+				case ARG_FLOAT_VEC:
+				{
+					double value;
+					float rounded;
+					res = toElement(element, value) && toFloat(value, rounded) && context.visit(value);
+					break;
+				}
+				default:
+				{
+					StringView value;
+					res = toElement(element, value) && context.visit(value);
+					break;
+				}
 				}
+
+				if (!res) return false;
 			}
 
-			if (!optionsExist) break;
+			return true;
+		}
+
+		/*////////////////////////////////////////////////////////////////////////////////////////////*/
 
-			if (onlyFlags)
+		SCLAP_INLINE bool visitArgument(VisitContext& context, ArgType type, int& inOutCurIndex,
+			char** inOutCurArgumentStr, int argc, char** inArgv)
+		{
+			// flags, the value is optional
+			if (type == ARG_BOOL)
 			{
-				mOptionValues.push_back(new hidden::OptionValueBool);
+				bool value = true;
+				if (inOutCurIndex < argc)
+				{
+					const bool isTrue = !strcmp(*inOutCurArgumentStr, "true");
+					if (isTrue || !strcmp(*inOutCurArgumentStr, "false"))
+					{
+						value = isTrue;
+						++inOutCurIndex;
+						*inOutCurArgumentStr = inArgv[inOutCurIndex];
+					}
+				}
+				return context.visit(value);
 			}
-			else
+
+			if (isSingleArgType(type))
 			{
-				uint8_t argumentValues = hidden::getTypeToRead(typeSingle, typeVector);
+				return inOutCurIndex < argc
+					&& visitElement(context, type, inOutCurIndex, inOutCurArgumentStr, inArgv);
+			}
+
+			const char delimiter = listDelimiter(context.options);
+			if (isPackedList(*inOutCurArgumentStr, inOutCurIndex, argc, inArgv, delimiter))
+			{
+				if (!visitPackedList(context, elementType(type), *inOutCurArgumentStr, delimiter)) return false;
+
+				++inOutCurIndex;
+				*inOutCurArgumentStr = inArgv[inOutCurIndex];
+				return true;
+			}
 
-				switch (argumentValues)
+			int count = 0;
+			while (inOutCurIndex < argc
+				&& **inOutCurArgumentStr != '-'
+				&& **inOutCurArgumentStr != '\0')
+			{
+				if (!visitElement(context, elementType(type), inOutCurIndex, inOutCurArgumentStr, inArgv))
 				{
-				case ARG_STRING:
-					mOptionValues.push_back(new hidden::OptionValueString); break;
-				case ARG_BOOL:
-					mOptionValues.push_back(new hidden::OptionValueBool); break;
-				case ARG_INT:
-					mOptionValues.push_back(new hidden::OptionValueInt); break;
-				case ARG_REAL:
-					mOptionValues.push_back(new hidden::OptionValueReal); break;
-				case ARG_STRING_VEC:
-					mOptionValues.push_back(new hidden::OptionValueStringVector); break;
-				case ARG_BOOL_VEC:
-					mOptionValues.push_back(new hidden::OptionValueBoolVector); break;
-				case ARG_INT_VEC:
-					mOptionValues.push_back(new hidden::OptionValueIntVector); break;
-				case ARG_REAL_VEC:
-					mOptionValues.push_back(new hidden::OptionValueRealVector); break;
-				default:
-					mError << "Read error.\n";
-					exit(-1);
+					return false;
 				}
+				++count;
 			}
 
-			if (!mOptionValues.back()->read(curIndex, &curArgumentStr, argc, argv))
+			return count > 0;
+		}
+	}
+
+	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+	SCLAP_INLINE bool visitOptions(const DescriptorSet& descriptors, int argc, char** argv,
+		OptionVisitor& visitor, Error* outError)
+	{
+		if (!descriptors.valid())
+		{
+			if (outError && !descriptors.errors().empty()) *outError = descriptors.errors()[0];
+			return false;
+		}
+
+		int curIndex = 1;
+		char* curArgumentStr = argv[curIndex];
+
+		hidden::ArgumentOptions argumentOptions;
+		while (curIndex < argc)
+		{
+			const int optionIndex = curIndex;
+			Error error;
+			if (!hidden::readOptionNames(descriptors, curIndex, &curArgumentStr, argv,
+				argumentOptions, error))
 			{
-				mOk = false;
-				mError << "Failed to read argument.\n";
-				return;
+				if (outError) *outError = error;
+				return false;
+			}
+
+			const ArgType argumentValues = hidden::valueType(argumentOptions);
+			if (argumentValues == UNEXISTED)
+			{
+				if (outError)
+				{
+					*outError = hidden::makeError(ERROR_WIDE_SHARED_ARGUMENT, argv[optionIndex],
+						strlen(argv[optionIndex]), optionIndex, 0);
+				}
+				return false;
 			}
 
-			for (std::set<std::string>::const_iterator it = optionNames.begin();
-				it != optionNames.end(); ++it)
+			hidden::VisitContext context = { argumentOptions, visitor, false };
+			if (!context.visitOptions()) return false;
+
+			if (!hidden::visitArgument(context, argumentValues,
+				curIndex, &curArgumentStr, argc, argv))
 			{
-				mOptions.push_back(new Option(mDescriptors[*it]->shortName(),
-					mDescriptors[*it]->longName(),
-					mOptionValues.back()));
+				if (outError && !context.stopped)
+				{
+					// where reading stopped, the option itself when the value is missing
+					const int index = curIndex < argc ? curIndex : optionIndex;
+					const char* subject = curIndex < argc ? curArgumentStr : argv[optionIndex];
+					*outError = hidden::makeError(ERROR_READ_ARGUMENT, subject, strlen(subject),
+						index, subject - argv[index]);
+				}
+				return false;
 			}
 		}
+
+		return true;
 	}
 
+#ifndef SCLAP_NO_THREADS
+
 	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
-	/*------------------------------------------------------------------------------------------------*/
-	/*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
+	SCLAP_INLINE std::vector<std::unique_ptr<Options> > parseBatch(const DescriptorSet& descriptors,
+		const std::vector<CommandLine>& commandLines, unsigned threads,
+		uint32_t flags)
+	{
+		if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+		std::vector<std::unique_ptr<Options> > results(commandLines.size());
+		const hidden::ParseTask task = { descriptors, commandLines, results, flags };
+		hidden::runWorkStealing(commandLines.size(), threads, task);
+
+		return results;
+	}
+
+#endif
 } // end of sclap
 
+#endif // !SCLAP_DECLARATIONS_ONLY
+
 #endif // !SCLAP_H
@@ -0,0 +1,425 @@
+#include "gtest/gtest.h"
+#include "sclap.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+// Heap use of parsing. Every allocation of the process is counted, the tests
+// compare the counts before and after parsing.
+
+static size_t gAllocations = 0;
+static size_t gAllocatedBytes = 0;
+
+#if defined(__GLIBC__)
+// malloc itself is replaced, operator new allocates through it.
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void __libc_free(void* ptr);
+
+    void* malloc(size_t size)
+    {
+        ++gAllocations;
+        gAllocatedBytes += size;
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        ++gAllocations;
+        gAllocatedBytes += count * size;
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, size_t size)
+    {
+        ++gAllocations;
+        gAllocatedBytes += size;
+        return __libc_realloc(ptr, size);
+    }
+
+    void free(void* ptr)
+    {
+        __libc_free(ptr);
+    }
+}
+#else
+// Elsewhere only operator new is counted.
+void* operator new(size_t size)
+{
+    ++gAllocations;
+    gAllocatedBytes += size;
+
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+#endif
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+struct AllocationCount
+{
+    size_t allocations;
+    size_t bytes;
+};
+
+// Counts the allocations from construction to stop().
+class AllocationCounter
+{
+public:
+    AllocationCounter() : mAllocations(gAllocations), mBytes(gAllocatedBytes) {}
+
+    AllocationCount stop() const
+    {
+        const AllocationCount count = { gAllocations - mAllocations, gAllocatedBytes - mBytes };
+        return count;
+    }
+
+private:
+    const size_t mAllocations;
+    const size_t mBytes;
+};
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+struct Scenario
+{
+    std::string name;
+    std::vector<sclap::OptionDescriptor> descriptors;
+    // without the program name
+    std::vector<std::string> arguments;
+};
+
+// Option names and values of the command line, each letter of a short option
+// cluster counts as one name.
+static size_t countValues(const Scenario& scenario)
+{
+    size_t values = 0;
+    for (size_t i = 0; i < scenario.arguments.size(); ++i)
+    {
+        const std::string& argument = scenario.arguments[i];
+        const bool cluster = argument.size() > 2 && argument[0] == '-' && argument[1] != '-';
+        values += cluster ? argument.size() - 1 : 1;
+    }
+    return values;
+}
+
+// argv of a scenario, pointing into its arguments.
+static std::vector<char*> makeArgv(Scenario& scenario)
+{
+    std::vector<char*> argv(1, (char*)"Program Name");
+    for (size_t i = 0; i < scenario.arguments.size(); ++i)
+    {
+        argv.push_back(&scenario.arguments[i][0]);
+    }
+    argv.push_back(NULL);
+    return argv;
+}
+
+static Scenario makeScenario(const std::string& name, const std::vector<sclap::OptionDescriptor>& descriptors,
+    const std::vector<std::string>& arguments)
+{
+    const Scenario scenario = { name, descriptors, arguments };
+    return scenario;
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+// Small command lines in the style of SingleReadTest, DoubleReadTest and RandomReadTest
+// (each type alone, with a second option, and a short cluster). They are written for
+// this test, not taken from tests.cpp.
+static std::vector<Scenario> readTestScenarios()
+{
+    typedef sclap::OptionDescriptor D;
+    typedef std::vector<std::string> A;
+
+    const D t[] = {
+        D('t', "test", sclap::ARG_BOOL), D('t', "test", sclap::ARG_INT), D('t', "test", sclap::ARG_REAL),
+        D('t', "test", sclap::ARG_STRING), D('t', "test", sclap::ARG_BOOL_VEC), D('t', "test", sclap::ARG_INT_VEC),
+        D('t', "test", sclap::ARG_REAL_VEC), D('t', "test", sclap::ARG_STRING_VEC)
+    };
+    const D e[] = {
+        D('e', "execute", sclap::ARG_BOOL), D('e', "execute", sclap::ARG_INT), D('e', "execute", sclap::ARG_REAL),
+        D('e', "execute", sclap::ARG_STRING), D('e', "execute", sclap::ARG_BOOL_VEC),
+        D('e', "execute", sclap::ARG_INT_VEC), D('e', "execute", sclap::ARG_REAL_VEC),
+        D('e', "execute", sclap::ARG_STRING_VEC)
+    };
+    const char* names[] = { "Bool", "Int", "Double", "String", "BoolVector", "IntVector",
+        "DoubleVector", "StringVector" };
+    const A values[] = {
+        A({ "-t=true" }), A({ "--test", "100" }), A({ "--test", "100.5" }), A({ "--test", "demo" }),
+        A({ "--test", "true", "false" }), A({ "--test", "12", "13" }), A({ "--test", "1.5", "2" }),
+        A({ "--test", "first", "second" })
+    };
+    const A otherValues[] = {
+        A({ "-e=false" }), A({ "-e", "-5" }), A({ "--execute=0.25" }), A({ "--execute", "x" }),
+        A({ "-e", "false", "true" }), A({ "-e", "7", "8", "9" }), A({ "-e=3.5" }), A({ "-e", "a", "b" })
+    };
+
+    std::vector<Scenario> scenarios;
+    for (size_t i = 0; i < sizeof(names) / sizeof(*names); ++i)
+    {
+        scenarios.push_back(makeScenario(std::string("SingleRead/") + names[i], { t[i] }, values[i]));
+
+        A both = values[i];
+        both.insert(both.end(), otherValues[i].begin(), otherValues[i].end());
+        scenarios.push_back(makeScenario(std::string("DoubleRead/") + names[i], { t[i], e[i] }, both));
+    }
+
+    scenarios.push_back(makeScenario("RandomRead/Random1",
+        { D('d', "download", sclap::ARG_STRING_VEC), D('e', "execute", sclap::ARG_STRING),
+          D('f', "friendly", sclap::ARG_BOOL), D('i', "interactive", sclap::ARG_BOOL) },
+        { "-defi", "demotest" }));
+
+    return scenarios;
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+// Larger generated command lines, names are kept alive by the returned storage.
+static std::vector<Scenario> generatedScenarios(std::vector<std::string>& names)
+{
+    const sclap::ArgType types[] = { sclap::ARG_BOOL, sclap::ARG_INT, sclap::ARG_REAL, sclap::ARG_STRING,
+        sclap::ARG_INT_VEC, sclap::ARG_REAL_VEC, sclap::ARG_STRING_VEC, sclap::ARG_SIZE };
+    const char* tokens[] = { "true", "42", "0.125", "value", "7", "2.5", "file", "64K" };
+    const size_t typeCount = sizeof(types) / sizeof(*types);
+
+    names.clear();
+    names.reserve(500);
+    for (int i = 0; i < 500; ++i)
+    {
+        names.push_back("option-" + std::to_string(i));
+    }
+
+    std::vector<Scenario> scenarios;
+
+    // 500 long options of all types, 3 values for vectors
+    Scenario mixed;
+    mixed.name = "Generated/Mixed500";
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        const size_t type = i % typeCount;
+        mixed.descriptors.push_back(sclap::OptionDescriptor(sclap::OPT_SHORT_NONE, names[i].c_str(), types[type]));
+        mixed.arguments.push_back("--" + names[i]);
+        const int count = (types[type] & (sclap::ARG_INT_VEC | sclap::ARG_REAL_VEC | sclap::ARG_STRING_VEC)) ? 3 : 1;
+        for (int j = 0; j < count; ++j) mixed.arguments.push_back(tokens[type]);
+    }
+    scenarios.push_back(mixed);
+
+    // one vector of 10000 integers, and the same packed with ranges
+    Scenario vector;
+    vector.name = "Generated/IntVector10000";
+    vector.descriptors.push_back(sclap::OptionDescriptor('v', "values", sclap::ARG_INT_VEC, ','));
+    vector.arguments.push_back("--values");
+    std::string packed = "--values=";
+    for (int i = 0; i < 10000; ++i)
+    {
+        vector.arguments.push_back(std::to_string(i * 7));
+        packed += std::to_string(i * 7) + ",";
+    }
+    packed += "1-1000";
+    scenarios.push_back(vector);
+
+    Scenario packedList;
+    packedList.name = "Generated/PackedList";
+    packedList.descriptors.push_back(vector.descriptors[0]);
+    packedList.arguments.push_back(packed);
+    scenarios.push_back(packedList);
+
+    // clusters of all 52 flags
+    Scenario clusters;
+    clusters.name = "Generated/ShortClusters";
+    const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    for (size_t i = 0; letters[i]; ++i)
+    {
+        clusters.descriptors.push_back(sclap::OptionDescriptor(letters[i], "", sclap::ARG_BOOL));
+    }
+    for (int i = 0; i < 100; ++i)
+    {
+        clusters.arguments.push_back(std::string("-") + letters);
+    }
+    scenarios.push_back(clusters);
+
+    return scenarios;
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+enum Mode
+{
+    MODE_HEAP,
+    MODE_HEAP_ZERO_COPY,
+    MODE_ARENA,
+    MODE_ARENA_ZERO_COPY,
+    MODE_ARENA_LAZY
+};
+
+static const char* modeName(Mode mode)
+{
+    switch (mode)
+    {
+    case MODE_HEAP: return "heap";
+    case MODE_HEAP_ZERO_COPY: return "heap zero copy";
+    case MODE_ARENA: return "arena";
+    case MODE_ARENA_ZERO_COPY: return "arena zero copy";
+    default: return "arena lazy";
+    }
+}
+
+// Parses the scenario in the mode and reads every value through the spans,
+// counting the allocations of both. The arena is reused, as in a service.
+static AllocationCount parse(Scenario& scenario, Mode mode, sclap::Arena& arena)
+{
+    sclap::OptionDescriptors descriptors(scenario.descriptors);
+    const std::shared_ptr<const sclap::CompiledDescriptors> compiled = descriptors.compile();
+    std::vector<char*> argv = makeArgv(scenario);
+    const int argc = (int)argv.size() - 1;
+
+    const bool useArena = mode >= MODE_ARENA;
+    uint32_t flags = sclap::PARSE_DEFAULT;
+    if (mode == MODE_HEAP_ZERO_COPY || mode == MODE_ARENA_ZERO_COPY) flags |= sclap::PARSE_ZERO_COPY;
+    if (mode == MODE_ARENA_LAZY) flags |= sclap::PARSE_LAZY;
+
+    arena.release();
+    AllocationCount count;
+    {
+        const AllocationCounter counter;
+        sclap::Options options(compiled, argc, argv.data(), useArena ? &arena : NULL, flags);
+        EXPECT_TRUE(options.valid()) << scenario.name << ": " << options.error();
+
+        for (size_t i = 0; i < scenario.descriptors.size(); ++i)
+        {
+            const sclap::OptionDescriptor& desc = scenario.descriptors[i];
+            const sclap::Option& option = desc.longNameSize() ? options[desc.longNameView().data()] : options[desc.shortName()];
+            EXPECT_NE(option.type(), sclap::UNEXISTED) << scenario.name;
+
+            option.asStringViews();
+            option.asRealSpan();
+            option.asIntegerSpan();
+            option.asBoolSpan();
+        }
+
+        count = counter.stop();
+    }
+    return count;
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+// Parsing with an arena and reused compiled descriptors must never touch the heap.
+// Without an arena, the count is bounded by the number of values.
+static void checkScenarios(std::vector<Scenario>& scenarios)
+{
+    static char buffer[1 << 22];
+    sclap::Arena arena(buffer, sizeof(buffer));
+
+    const Mode modes[] = { MODE_HEAP, MODE_HEAP_ZERO_COPY, MODE_ARENA, MODE_ARENA_ZERO_COPY, MODE_ARENA_LAZY };
+    for (size_t s = 0; s < scenarios.size(); ++s)
+    {
+        for (size_t m = 0; m < sizeof(modes) / sizeof(*modes); ++m)
+        {
+            const AllocationCount count = parse(scenarios[s], modes[m], arena);
+            printf("%-28s %-16s %8zu allocations %10zu bytes\n", scenarios[s].name.c_str(),
+                modeName(modes[m]), count.allocations, count.bytes);
+
+            if (modes[m] >= MODE_ARENA)
+            {
+                EXPECT_EQ(count.allocations, 0u) << scenarios[s].name << " " << modeName(modes[m]);
+            }
+            else
+            {
+                EXPECT_LE(count.allocations, 32 + 4 * countValues(scenarios[s]))
+                    << scenarios[s].name << " " << modeName(modes[m]);
+            }
+        }
+    }
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(AllocationTest, ReadTestScenarios)
+{
+    std::vector<Scenario> scenarios = readTestScenarios();
+    checkScenarios(scenarios);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(AllocationTest, GeneratedScenarios)
+{
+    std::vector<std::string> names;
+    std::vector<Scenario> scenarios = generatedScenarios(names);
+    checkScenarios(scenarios);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(AllocationTest, Counting)
+{
+    const AllocationCounter counter;
+    std::vector<int>* heap = new std::vector<int>(1000);
+    const AllocationCount count = counter.stop();
+    delete heap;
+
+    EXPECT_EQ(count.allocations, 2u);
+    EXPECT_GE(count.bytes, 1000 * sizeof(int));
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+// Block sizes start from the initial size again after release(), an arena reused
+// for many parses does not allocate ever larger blocks.
+TEST(AllocationTest, ArenaReuse)
+{
+    sclap::Arena arena(256);
+
+    AllocationCount first = { 0, 0 };
+    for (int round = 0; round < 5; ++round)
+    {
+        const AllocationCounter counter;
+        for (int i = 0; i < 100; ++i) arena.allocate(64, 8);
+        const AllocationCount count = counter.stop();
+        arena.release();
+
+        if (round == 0)
+        {
+            first = count;
+            continue;
+        }
+        EXPECT_EQ(count.allocations, first.allocations);
+        EXPECT_EQ(count.bytes, first.bytes);
+    }
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
@@ -0,0 +1,560 @@
+#include "sclap.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+// Parser throughput benchmark.
+// Usage: sclap_bench [minimum seconds per scenario] [name filter]
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+static size_t gAllocations = 0;
+static size_t gAllocatedBytes = 0;
+
+// Counted like alloc_tests.cpp: with glibc malloc itself is replaced, so every form of
+// operator new is seen (aligned ones through aligned_alloc), elsewhere the plain, array
+// and nothrow forms of operator new.
+#if defined(__GLIBC__)
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* ptr);
+
+    void* malloc(size_t size)
+    {
+        ++gAllocations;
+        gAllocatedBytes += size;
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        ++gAllocations;
+        gAllocatedBytes += count * size;
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, size_t size)
+    {
+        ++gAllocations;
+        gAllocatedBytes += size;
+        return __libc_realloc(ptr, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        ++gAllocations;
+        gAllocatedBytes += size;
+        return __libc_memalign(alignment, size);
+    }
+
+    void free(void* ptr)
+    {
+        __libc_free(ptr);
+    }
+}
+#else
+void* operator new(size_t size)
+{
+    ++gAllocations;
+    gAllocatedBytes += size;
+
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    try { return operator new(size); } catch (...) { return NULL; }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    try { return operator new(size); } catch (...) { return NULL; }
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+#endif
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+enum Layout
+{
+    LONG_OPTIONS,   // --option-N value...
+    SHORT_CLUSTERS  // -abcde (flags only)
+};
+
+struct Scenario
+{
+    std::string name;
+    int descriptors;
+    int tokens;
+    Layout layout;
+    sclap::ArgType type;
+    int vectorLength;
+    uint32_t flags;
+};
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+// Owns generated argument strings and the argv array pointing into them.
+struct CommandLine
+{
+    std::vector<std::string> arguments;
+    std::vector<char*> argv;
+    int tokens;
+
+    CommandLine() : tokens(0) {}
+
+    void add(const std::string& argument) { arguments.push_back(argument); }
+
+    void finish()
+    {
+        argv.clear();
+        for (size_t i = 0; i < arguments.size(); ++i)
+        {
+            argv.push_back(&arguments[i][0]);
+        }
+        argv.push_back(NULL);
+        tokens = argc();
+    }
+
+    int argc() const { return (int)argv.size() - 1; }
+};
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+static const char kShortNames[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+static std::string longName(int i)
+{
+    return "option-" + std::to_string(i);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+static std::string valueToken(sclap::ArgType type, int i)
+{
+    switch (type)
+    {
+    case sclap::ARG_BOOL:
+    case sclap::ARG_BOOL_VEC:
+        return i % 2 ? "true" : "false";
+    case sclap::ARG_INT:
+    case sclap::ARG_INT_VEC:
+        return std::to_string(i * 7919LL % 1000000);
+    case sclap::ARG_REAL:
+    case sclap::ARG_REAL_VEC:
+    case sclap::ARG_FLOAT_VEC:
+        return std::to_string(i % 1000) + "." + std::to_string(i * 31LL % 10000);
+    case sclap::ARG_INT64:
+        return std::to_string((i % 2 ? -1 : 1) * (i * 7919LL % 1000000 + 5000000000LL));
+    case sclap::ARG_UINT64:
+        return std::to_string(i * 7919ULL % 1000000 + 10000000000000000000ULL);
+    case sclap::ARG_SIZE:
+        return std::to_string(i % 1000) + "KMG"[i % 3];
+    default:
+        return "/some/path/to/file-" + std::to_string(i) + ".dat";
+    }
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+static void buildDescriptors(const Scenario& scenario, sclap::OptionDescriptors& descriptors)
+{
+    const sclap::ArgType type = scenario.layout == SHORT_CLUSTERS ? sclap::ARG_BOOL : scenario.type;
+
+    for (int i = 0; i < scenario.descriptors; ++i)
+    {
+        const char shortName = i < (int)sizeof(kShortNames) - 1 ? kShortNames[i] : sclap::OPT_SHORT_NONE;
+        descriptors << sclap::OptionDescriptor(shortName, longName(i).c_str(), type);
+    }
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+static void buildCommandLine(const Scenario& scenario, CommandLine& commandLine)
+{
+    commandLine.add("bench");
+
+    int tokens = 0;
+    int option = 0;
+    while (tokens < scenario.tokens)
+    {
+        if (scenario.layout == SHORT_CLUSTERS)
+        {
+            // clusters of up to 5 distinct flags
+            const int shortCount = std::min(scenario.descriptors, (int)sizeof(kShortNames) - 1);
+            std::string cluster = "-";
+            for (int i = 0; i < 5 && i < shortCount; ++i)
+            {
+                cluster.push_back(kShortNames[(option + i) % shortCount]);
+            }
+            commandLine.add(cluster);
+            option += 5;
+            ++tokens;
+            continue;
+        }
+
+        commandLine.add("--" + longName(option % scenario.descriptors));
+        ++tokens;
+
+        if (scenario.type == sclap::ARG_BOOL)
+        {
+            // plain flag
+        }
+        else if (sclap::hidden::isSingleArgType(scenario.type))
+        {
+            commandLine.add(valueToken(scenario.type, option));
+            ++tokens;
+        }
+        else
+        {
+            for (int i = 0; i < scenario.vectorLength; ++i)
+            {
+                commandLine.add(valueToken(scenario.type, option + i));
+                ++tokens;
+            }
+        }
+
+        ++option;
+    }
+
+    commandLine.finish();
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+static void run(const Scenario& scenario, double minSeconds)
+{
+    sclap::OptionDescriptors descriptors;
+    buildDescriptors(scenario, descriptors);
+
+    CommandLine commandLine;
+    buildCommandLine(scenario, commandLine);
+
+    // the same arguments passed through a response file
+    const char* responsePath = "sclap_bench.rsp";
+    if (scenario.flags & sclap::PARSE_RESPONSE_FILES)
+    {
+        std::ofstream file(responsePath);
+        for (size_t i = 1; i < commandLine.arguments.size(); ++i)
+        {
+            file << commandLine.arguments[i] << '\n';
+        }
+
+        const int tokens = commandLine.argc();
+        commandLine = CommandLine();
+        commandLine.add("bench");
+        commandLine.add(std::string("@") + responsePath);
+        commandLine.finish();
+        commandLine.tokens = tokens;
+    }
+
+    // allocations of a single parse
+    const size_t allocationsBefore = gAllocations;
+    const size_t bytesBefore = gAllocatedBytes;
+    bool valid = false;
+    {
+        sclap::Options options(descriptors, commandLine.argc(), &commandLine.argv[0], NULL, scenario.flags);
+        valid = options.valid();
+    }
+    const size_t allocations = gAllocations - allocationsBefore;
+    const size_t bytes = gAllocatedBytes - bytesBefore;
+
+    // parse throughput
+    int parses = 0;
+    const Clock::time_point parseStart = Clock::now();
+    double parseSeconds = 0;
+    do
+    {
+        sclap::Options options(descriptors, commandLine.argc(), &commandLine.argv[0], NULL, scenario.flags);
+        ++parses;
+        parseSeconds = secondsSince(parseStart);
+    } while (parseSeconds < minSeconds);
+
+    // lookup of every option name by long and short name
+    sclap::Options options(descriptors, commandLine.argc(), &commandLine.argv[0], NULL, scenario.flags);
+
+    std::vector<std::string> names;
+    for (int i = 0; i < scenario.descriptors; ++i)
+    {
+        names.push_back(longName(i));
+    }
+
+    size_t lookups = 0;
+    size_t found = 0;
+    const Clock::time_point lookupStart = Clock::now();
+    double lookupSeconds = 0;
+    do
+    {
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            found += options[names[i]].type() != sclap::UNEXISTED;
+            found += options[kShortNames[i % (sizeof(kShortNames) - 1)]].type() != sclap::UNEXISTED;
+        }
+        lookups += names.size() * 2;
+        lookupSeconds = secondsSince(lookupStart);
+    } while (lookupSeconds < minSeconds / 4);
+
+    if (scenario.flags & sclap::PARSE_RESPONSE_FILES) remove(responsePath);
+
+    const double tokensPerSecond = (double)commandLine.tokens * parses / parseSeconds;
+
+    printf("%-28s %8d %9d %14.0f %10zu %12zu %12.1f %s\n",
+        scenario.name.c_str(), scenario.descriptors, commandLine.tokens,
+        tokensPerSecond, allocations, bytes, lookupSeconds * 1e9 / lookups,
+        valid && found ? "" : "(parse failed)");
+    fflush(stdout);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+// Splitting a whole command line string, the copy of the text is included
+// because tokens are terminated in place.
+static void runTokenize(const std::string& name, const std::string& text, double minSeconds)
+{
+    std::vector<char> line(text.size() + 1);
+
+    int splits = 0;
+    int tokens = 0;
+    const Clock::time_point start = Clock::now();
+    double seconds = 0;
+    do
+    {
+        memcpy(line.data(), text.c_str(), text.size() + 1);
+        sclap::CommandLineArguments arguments(line.data(), text.size());
+        tokens = arguments.argc();
+        ++splits;
+        seconds = secondsSince(start);
+    } while (seconds < minSeconds);
+
+    printf("%-28s %8s %9d %14.0f %10s %12s %12s %.2f GB/s\n",
+        name.c_str(), "", tokens, (double)tokens * splits / seconds, "", "", "",
+        (double)text.size() * splits / seconds / 1e9);
+    fflush(stdout);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+// Loading a config file of about 10 MB, one line per option of mixed types.
+static void runConfigFile(const std::string& name, uint32_t flags, double minSeconds)
+{
+    const sclap::ArgType types[] = { sclap::ARG_STRING, sclap::ARG_INT, sclap::ARG_REAL, sclap::ARG_INT_VEC };
+
+    const char* path = "sclap_bench.conf";
+    sclap::OptionDescriptors descriptors;
+    size_t size = 0;
+    {
+        std::string text;
+        for (int i = 0; text.size() < (10 << 20); ++i)
+        {
+            const sclap::ArgType type = types[i % 4];
+            descriptors << sclap::OptionDescriptor(sclap::OPT_SHORT_NONE, longName(i).c_str(), type);
+
+            text += longName(i) + " = " + valueToken(type, i);
+            if (type == sclap::ARG_STRING) text += std::string(200, 'x');
+            for (int j = 1; type == sclap::ARG_INT_VEC && j < 64; ++j)
+            {
+                text += " " + valueToken(type, i + j);
+            }
+            text += "\n";
+        }
+
+        FILE* file = fopen(path, "wb");
+        fwrite(text.data(), 1, text.size(), file);
+        fclose(file);
+        size = text.size();
+    }
+
+    const std::shared_ptr<const sclap::CompiledDescriptors> compiled = descriptors.compile();
+    char* argv[] = { (char*)"bench", NULL };
+
+    sclap::Arena arena(1 << 20);
+    int loads = 0;
+    bool valid = true;
+    const Clock::time_point start = Clock::now();
+    double seconds = 0;
+    do
+    {
+        arena.release();
+        sclap::Options options(compiled, 1, argv, &arena, flags);
+        valid = options.readConfigFile(path) && valid;
+        ++loads;
+        seconds = secondsSince(start);
+    } while (seconds < minSeconds);
+    std::remove(path);
+
+    printf("%-28s %8zu %9s %14s %10s %12s %12s %.2f ms %.2f GB/s %s\n",
+        name.c_str(), compiled->size(), "", "", "", "", "", seconds * 1e3 / loads,
+        (double)size * loads / seconds / 1e9, valid ? "" : "(parse failed)");
+    fflush(stdout);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+int main(int argc, char** argv)
+{
+    const double minSeconds = argc > 1 ? atof(argv[1]) : 0.5;
+    const std::string filter = argc > 2 ? argv[2] : "";
+
+    std::vector<Scenario> scenarios;
+
+    // token count
+    for (int tokens = 10; tokens <= 1000000; tokens *= 10)
+    {
+        Scenario s = { "tokens/" + std::to_string(tokens), 100, tokens, LONG_OPTIONS, sclap::ARG_INT, 0, sclap::PARSE_DEFAULT };
+        scenarios.push_back(s);
+    }
+
+    // descriptor count
+    for (int descriptors = 10; descriptors <= 10000; descriptors *= 10)
+    {
+        Scenario s = { "descriptors/" + std::to_string(descriptors), descriptors, 10000,
+            LONG_OPTIONS, sclap::ARG_BOOL, 0, sclap::PARSE_DEFAULT };
+        scenarios.push_back(s);
+    }
+
+    // short clusters vs long options
+    {
+        Scenario s = { "layout/short-clusters", 52, 100000, SHORT_CLUSTERS, sclap::ARG_BOOL, 0, sclap::PARSE_DEFAULT };
+        scenarios.push_back(s);
+        Scenario l = { "layout/long-options", 52, 100000, LONG_OPTIONS, sclap::ARG_BOOL, 0,
+            sclap::PARSE_DEFAULT };
+        scenarios.push_back(l);
+    }
+
+    // response file, copied and zero copy string values
+    {
+        Scenario s = { "response-file/copy", 100, 1000000, LONG_OPTIONS, sclap::ARG_STRING, 0,
+            sclap::PARSE_RESPONSE_FILES };
+        scenarios.push_back(s);
+        Scenario z = { "response-file/zero-copy", 100, 1000000, LONG_OPTIONS, sclap::ARG_STRING, 0,
+            sclap::PARSE_RESPONSE_FILES | sclap::PARSE_ZERO_COPY };
+        scenarios.push_back(z);
+    }
+
+    // conversion on access only
+    {
+        Scenario s = { "lazy/int-vec", 100, 100000, LONG_OPTIONS, sclap::ARG_INT_VEC, 8,
+            sclap::PARSE_LAZY };
+        scenarios.push_back(s);
+    }
+
+    // value types
+    const struct { const char* name; sclap::ArgType type; } types[] = {
+        { "string", sclap::ARG_STRING }, { "bool", sclap::ARG_BOOL },
+        { "int", sclap::ARG_INT }, { "real", sclap::ARG_REAL },
+        { "int64", sclap::ARG_INT64 }, { "uint64", sclap::ARG_UINT64 }, { "size", sclap::ARG_SIZE },
+        { "string-vec", sclap::ARG_STRING_VEC }, { "bool-vec", sclap::ARG_BOOL_VEC },
+        { "int-vec", sclap::ARG_INT_VEC }, { "real-vec", sclap::ARG_REAL_VEC },
+        { "float-vec", sclap::ARG_FLOAT_VEC }
+    };
+    for (size_t i = 0; i < sizeof(types) / sizeof(*types); ++i)
+    {
+        Scenario s = { std::string("type/") + types[i].name, 100, 100000,
+            LONG_OPTIONS, types[i].type, 8, sclap::PARSE_DEFAULT };
+        scenarios.push_back(s);
+    }
+
+    // large vectors: a single option with a million values
+    for (size_t i = 0; i < sizeof(types) / sizeof(*types); ++i)
+    {
+        if (sclap::hidden::isSingleArgType(types[i].type)) continue;
+
+        Scenario s = { std::string("large/") + types[i].name, 1, 1000001,
+            LONG_OPTIONS, types[i].type, 1000000, sclap::PARSE_DEFAULT };
+        scenarios.push_back(s);
+    }
+
+    printf("%-28s %8s %9s %14s %10s %12s %12s\n",
+        "scenario", "descs", "tokens", "tokens/s", "allocs", "bytes", "lookup ns");
+
+    for (size_t i = 0; i < scenarios.size(); ++i)
+    {
+        if (scenarios[i].name.find(filter) == std::string::npos) continue;
+        run(scenarios[i], minSeconds);
+    }
+
+    // 8 MB command line strings: long unquoted values and short quoted ones
+    const std::string longValues = "tokenize/long-values";
+    if (longValues.find(filter) != std::string::npos)
+    {
+        std::string text = "bench";
+        for (int i = 0; text.size() < (8 << 20); ++i)
+        {
+            text += " --" + longName(i % 100) + "=" + valueToken(sclap::ARG_STRING, i) + std::string(64, 'x');
+        }
+        runTokenize(longValues, text, minSeconds);
+    }
+
+    const std::string quoted = "tokenize/quoted";
+    if (quoted.find(filter) != std::string::npos)
+    {
+        std::string text = "bench";
+        for (int i = 0; text.size() < (8 << 20); ++i)
+        {
+            text += " --" + longName(i % 100) + " 'two words' \"a \\\"b\\\"\" c\\ d";
+        }
+        runTokenize(quoted, text, minSeconds);
+    }
+
+    // config file, copied and zero copy string values
+    const std::string config = "config-file/copy";
+    if (config.find(filter) != std::string::npos)
+    {
+        runConfigFile(config, sclap::PARSE_DEFAULT, minSeconds);
+    }
+
+    const std::string configZeroCopy = "config-file/zero-copy";
+    if (configZeroCopy.find(filter) != std::string::npos)
+    {
+        runConfigFile(configZeroCopy, sclap::PARSE_ZERO_COPY, minSeconds);
+    }
+
+    return 0;
+}
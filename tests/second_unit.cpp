@@ -0,0 +1,15 @@
+#include "sclap.h"
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+// Parses in a translation unit of its own, so tests.cpp and this file both include sclap.h.
+int parseCountInSecondUnit(int argc, char** argv)
+{
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('c', "count", sclap::ARG_INT);
+
+    sclap::Options options(descriptors, argc, argv);
+    if (!options.valid()) return -1;
+
+    return options["count"].asInteger();
+}
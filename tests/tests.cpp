@@ -1,6 +1,12 @@
 #include "gtest/gtest.h"
 #include "sclap.h"
 
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
 /*////////////////////////////////////////////////////////////////////////////////////////////////*/
 
 int main(int argc, char** argv)
@@ -605,4 +611,2081 @@ TEST(RandomReadTest, Random1)
     EXPECT_EQ(options['i'].type(), sclap::ARG_STRING_VEC);
 }
 
-/*////////////////////////////////////////////////////////////////////////////////////////////////*/
\ No newline at end of file
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+TEST(LookupTest, ManyDescriptors)
+{
+    sclap::OptionDescriptors descriptors;
+    std::vector<std::string> longNames;
+    for (int i = 0; i < 500; ++i)
+    {
+        longNames.push_back("option" + std::to_string(i));
+    }
+    for (int i = 0; i < 500; ++i)
+    {
+        const char shortName = (i >= 'a' && i <= 'z') ? (char)i : sclap::OPT_SHORT_NONE;
+        // OptionDescriptors keeps its own copy of the name
+        descriptors << sclap::OptionDescriptor(shortName, longNames[i], sclap::ARG_INT);
+    }
+    EXPECT_TRUE(descriptors.valid());
+
+    for (int i = 0; i < 500; ++i)
+    {
+        ASSERT_TRUE(descriptors[longNames[i]] != NULL);
+        EXPECT_EQ(descriptors[longNames[i]]->longName(), longNames[i]);
+        EXPECT_EQ(descriptors[longNames[i]]->longNameView(), longNames[i]);
+    }
+    for (char c = 'a'; c <= 'z'; ++c)
+    {
+        ASSERT_TRUE(descriptors[c] != NULL);
+        EXPECT_EQ(descriptors[c]->shortName(), c);
+        EXPECT_TRUE(descriptors[std::string(1, c)] == descriptors[c]);
+    }
+
+    EXPECT_TRUE(descriptors['A'] == NULL);
+    EXPECT_TRUE(descriptors[sclap::OPT_SHORT_NONE] == NULL);
+    EXPECT_TRUE(descriptors["option500"] == NULL);
+    EXPECT_TRUE(descriptors[""] == NULL);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(LookupTest, OwnedNames)
+{
+    // descriptors own their names, also when built from temporaries
+    std::vector<sclap::OptionDescriptor>* source = new std::vector<sclap::OptionDescriptor>();
+    for (int i = 0; i < 50; ++i)
+    {
+        source->push_back(sclap::OptionDescriptor(sclap::OPT_SHORT_NONE,
+            std::string("temporary-option-name-") + std::to_string(i), sclap::ARG_INT));
+        source->push_back(sclap::OptionDescriptor(sclap::OPT_SHORT_NONE,
+            ("c-str-option-name-" + std::to_string(i)).c_str(), sclap::ARG_INT, sclap::LIST_DELIMITER_NONE,
+            ("SCLAP_TEST_NAME_" + std::to_string(i)).c_str()));
+    }
+    source->push_back(sclap::OptionDescriptor('z', std::string("zero\0inside", 11), sclap::ARG_BOOL));
+
+    sclap::OptionDescriptors descriptors(*source);
+    delete source;
+
+    std::shared_ptr<const sclap::CompiledDescriptors> compiled = descriptors.compile();
+    EXPECT_TRUE(descriptors.valid());
+    for (int i = 0; i < 50; ++i)
+    {
+        const std::string name = "temporary-option-name-" + std::to_string(i);
+        ASSERT_TRUE(descriptors[name] != NULL);
+        EXPECT_EQ(descriptors[name]->longName(), name);
+        ASSERT_TRUE((*compiled)[name] != NULL);
+        EXPECT_EQ((*compiled)[name]->longName(), name);
+
+        const std::string cStrName = "c-str-option-name-" + std::to_string(i);
+        ASSERT_TRUE(descriptors[cStrName] != NULL);
+        EXPECT_STREQ(descriptors[cStrName]->environmentName(), ("SCLAP_TEST_NAME_" + std::to_string(i)).c_str());
+        EXPECT_STREQ(compiled->environmentDescriptor(i).environmentName(),
+            ("SCLAP_TEST_NAME_" + std::to_string(i)).c_str());
+    }
+    EXPECT_EQ(descriptors['z']->longName(), std::string("zero\0inside", 11));
+    EXPECT_EQ(descriptors['z']->longNameSize(), 11u);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(LookupTest, FirstDescriptorWins)
+{
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('t', "test", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('t', "test", sclap::ARG_INT);
+
+    sclap::OptionDescriptors copy(descriptors);
+
+    EXPECT_EQ(descriptors['t']->possibleArgumentValues(), sclap::ARG_BOOL);
+    EXPECT_EQ(descriptors["test"]->possibleArgumentValues(), sclap::ARG_BOOL);
+    EXPECT_EQ(copy['t']->possibleArgumentValues(), sclap::ARG_BOOL);
+    EXPECT_EQ(copy["test"]->possibleArgumentValues(), sclap::ARG_BOOL);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+constexpr sclap::SchemaOption kSchemaOptions[] = {
+    sclap::SchemaOption('t', "test", sclap::ARG_INT),
+    sclap::SchemaOption('e', "est", sclap::ARG_REAL_VEC),
+    sclap::SchemaOption('f', "", sclap::ARG_BOOL),
+    sclap::SchemaOption(sclap::OPT_SHORT_NONE, "long-only", sclap::ARG_STRING)
+};
+
+typedef sclap::Schema<sizeof(kSchemaOptions) / sizeof(*kSchemaOptions), kSchemaOptions> TestSchema;
+
+static_assert(kSchemaOptions[1].longNameSize() == 3, "Long name length is computed at compile time.");
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(SchemaTest, Lookup)
+{
+    const TestSchema schema;
+    EXPECT_TRUE(schema.valid());
+
+    EXPECT_EQ(schema['t'], &kSchemaOptions[0]);
+    EXPECT_EQ(schema["test"], &kSchemaOptions[0]);
+    EXPECT_EQ(schema["e"], &kSchemaOptions[1]);
+    EXPECT_EQ(schema["est"], &kSchemaOptions[1]);
+    EXPECT_EQ(schema['f'], &kSchemaOptions[2]);
+    EXPECT_EQ(schema["long-only"], &kSchemaOptions[3]);
+
+    EXPECT_TRUE(schema[sclap::OPT_SHORT_NONE] == NULL);
+    EXPECT_TRUE(schema['x'] == NULL);
+    EXPECT_TRUE(schema[""] == NULL);
+    EXPECT_TRUE(schema["tes"] == NULL);
+    EXPECT_TRUE(schema["long-onl"] == NULL);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(SchemaTest, Parse)
+{
+    int argc = 7;
+    char* argv[7];
+    argv[0] = "Program Name";
+    argv[1] = "--test";
+    argv[2] = "100";
+    argv[3] = "-ef";
+    argv[4] = "1.5";
+    argv[5] = "--long-only";
+    argv[6] = "value";
+
+    static const TestSchema schema;
+
+    sclap::Options options(schema, argc, argv);
+    EXPECT_TRUE(options.valid());
+
+    EXPECT_EQ(options["test"].asInteger(), 100);
+    EXPECT_EQ(options['e'].asRealVector().at(0), 1.5);
+    EXPECT_TRUE(options['f']);
+    EXPECT_EQ(options["long-only"].asString(), "value");
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(SchemaTest, HashMatchesRuntime)
+{
+    EXPECT_EQ(sclap::hidden::constHashName("long-only", 9), sclap::hidden::hashName("long-only", 9));
+    EXPECT_EQ(sclap::hidden::constHashName("", 0), sclap::hidden::hashName("", 0));
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(ArenaTest, Allocate)
+{
+    char buffer[256];
+    sclap::Arena arena(buffer, sizeof(buffer));
+
+    void* a = arena.allocate(3, 1);
+    void* b = arena.allocate(8, 8);
+    EXPECT_EQ(a, (void*)buffer);
+    EXPECT_EQ((size_t)b % 8, 0u);
+    EXPECT_TRUE((char*)b >= buffer && (char*)b < buffer + sizeof(buffer));
+
+    // does not fit into the buffer, goes to the heap
+    void* c = arena.allocate(1024, 16);
+    EXPECT_TRUE((char*)c < buffer || (char*)c >= buffer + sizeof(buffer));
+    EXPECT_EQ((size_t)c % 16, 0u);
+
+    arena.release();
+    EXPECT_EQ(arena.allocate(3, 1), (void*)buffer);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(ArenaTest, Parse)
+{
+    int argc = 9;
+    char* argv[9];
+    argv[0] = "Program Name";
+    argv[1] = "--download";
+    argv[2] = "first-file-with-a-long-name";
+    argv[3] = "second-file-with-a-long-name";
+    argv[4] = "-t";
+    argv[5] = "12";
+    argv[6] = "13";
+    argv[7] = "--execute=x";
+    argv[8] = "-f";
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('d', "download", sclap::ARG_STRING_VEC)
+                << sclap::OptionDescriptor('t', "test", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('e', "execute", sclap::ARG_STRING)
+                << sclap::OptionDescriptor('f', "friendly", sclap::ARG_BOOL);
+
+    char buffer[4096];
+    sclap::Arena arena(buffer, sizeof(buffer));
+    {
+        sclap::Options options(descriptors, argc, argv, &arena);
+        EXPECT_TRUE(options.valid());
+
+        EXPECT_EQ(options["download"].asStringVector().at(1), "second-file-with-a-long-name");
+        EXPECT_EQ(options['t'].asIntegerVector().at(1), 13);
+        EXPECT_EQ(options["execute"].asString(), "x");
+        EXPECT_TRUE(options["friendly"]);
+        EXPECT_EQ(options["friendly"].longName(), "friendly");
+    }
+    arena.release();
+
+    sclap::Options options(descriptors, argc, argv, &arena);
+    EXPECT_TRUE(options.valid());
+    EXPECT_EQ(options['d'].asString(), "first-file-with-a-long-name");
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(ZeroCopyTest, StringViews)
+{
+    int argc = 6;
+    char* argv[6];
+    argv[0] = "Program Name";
+    argv[1] = "--execute=command";
+    argv[2] = "-d";
+    argv[3] = "first";
+    argv[4] = "second";
+    argv[5] = "third";
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('d', "download", sclap::ARG_STRING_VEC)
+                << sclap::OptionDescriptor('e', "execute", sclap::ARG_STRING);
+
+    sclap::Options options(descriptors, argc, argv, NULL, sclap::PARSE_ZERO_COPY);
+    EXPECT_TRUE(options.valid());
+
+    EXPECT_EQ(options['e'].asStringView(), "command");
+    EXPECT_EQ(options['e'].asStringView().data(), argv[1] + strlen("--execute="));
+
+    sclap::Span<sclap::StringView> files = options["download"].asStringViews();
+    ASSERT_EQ(files.size(), 3u);
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        EXPECT_EQ(files[i].data(), argv[3 + i]);
+    }
+    EXPECT_EQ(files[2], "third");
+    EXPECT_EQ(options['d'].asString(), "first");
+    EXPECT_EQ(options['d'].asStringVector().at(1), "second");
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(ZeroCopyTest, CopyByDefault)
+{
+    char execute[] = "--execute=command";
+    char first[] = "first";
+    char second[] = "second";
+
+    int argc = 5;
+    char* argv[5];
+    argv[0] = "Program Name";
+    argv[1] = execute;
+    argv[2] = "-d";
+    argv[3] = first;
+    argv[4] = second;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('d', "download", sclap::ARG_STRING_VEC)
+                << sclap::OptionDescriptor('e', "execute", sclap::ARG_STRING);
+
+    sclap::Options options(descriptors, argc, argv);
+    EXPECT_TRUE(options.valid());
+
+    memset(execute, 'x', strlen(execute));
+    memset(first, 'x', strlen(first));
+    memset(second, 'x', strlen(second));
+
+    EXPECT_EQ(options['e'].asStringView(), "command");
+    EXPECT_EQ(options['d'].asStringViews()[0], "first");
+    EXPECT_EQ(options['d'].asStringViews()[1], "second");
+    EXPECT_EQ(options['d'].asStringVector().at(1), "second");
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(NumberTest, Integer)
+{
+    int value = 0;
+    EXPECT_TRUE(sclap::hidden::toInteger("0", value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(sclap::hidden::toInteger("+17", value));
+    EXPECT_EQ(value, 17);
+    EXPECT_TRUE(sclap::hidden::toInteger("-2147483648", value));
+    EXPECT_EQ(value, INT_MIN);
+    EXPECT_TRUE(sclap::hidden::toInteger("2147483647", value));
+    EXPECT_EQ(value, INT_MAX);
+    EXPECT_TRUE(sclap::hidden::toInteger("000000000000000000000000042", value));
+    EXPECT_EQ(value, 42);
+
+    EXPECT_FALSE(sclap::hidden::toInteger("2147483648", value));
+    EXPECT_FALSE(sclap::hidden::toInteger("-2147483649", value));
+    EXPECT_FALSE(sclap::hidden::toInteger("99999999999999999999999", value));
+    EXPECT_FALSE(sclap::hidden::toInteger("", value));
+    EXPECT_FALSE(sclap::hidden::toInteger("-", value));
+    EXPECT_FALSE(sclap::hidden::toInteger(" 1", value));
+    EXPECT_FALSE(sclap::hidden::toInteger("1.5", value));
+    EXPECT_FALSE(sclap::hidden::toInteger("12a", value));
+
+    const char number[] = "123abc";
+    sclap::hidden::NumberResult res = sclap::hidden::parseInteger(number, number + 6, value);
+    EXPECT_EQ(res.ec, std::errc());
+    EXPECT_EQ(res.ptr, number + 3);
+    EXPECT_EQ(value, 123);
+
+    unsigned int unsignedValue = 0;
+    res = sclap::hidden::parseInteger(number, number + 6, unsignedValue);
+    EXPECT_EQ(unsignedValue, 123u);
+    const char negative[] = "-1";
+    res = sclap::hidden::parseInteger(negative, negative + 2, unsignedValue);
+    EXPECT_EQ(res.ec, std::errc::invalid_argument);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(NumberTest, Real)
+{
+    double value = 0;
+    EXPECT_TRUE(sclap::hidden::toDouble("100.25", value));
+    EXPECT_EQ(value, 100.25);
+    EXPECT_TRUE(sclap::hidden::toDouble("-.5e1", value));
+    EXPECT_EQ(value, -5);
+    EXPECT_TRUE(sclap::hidden::toDouble("5.", value));
+    EXPECT_EQ(value, 5);
+    EXPECT_TRUE(sclap::hidden::toDouble("-0.0", value));
+    EXPECT_TRUE(value == 0 && std::signbit(value));
+    EXPECT_TRUE(sclap::hidden::toDouble("inf", value));
+    EXPECT_TRUE(std::isinf(value));
+    EXPECT_TRUE(sclap::hidden::toDouble("-Infinity", value));
+    EXPECT_TRUE(std::isinf(value) && value < 0);
+    EXPECT_TRUE(sclap::hidden::toDouble("NaN", value));
+    EXPECT_TRUE(std::isnan(value));
+
+    EXPECT_FALSE(sclap::hidden::toDouble("1e400", value));
+    EXPECT_FALSE(sclap::hidden::toDouble("", value));
+    EXPECT_FALSE(sclap::hidden::toDouble(".", value));
+    EXPECT_FALSE(sclap::hidden::toDouble("1e", value));
+    EXPECT_FALSE(sclap::hidden::toDouble("1,5", value));
+    EXPECT_FALSE(sclap::hidden::toDouble("0x10", value));
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(NumberTest, RealMatchesStrtod)
+{
+    const char* numbers[] = {
+        "0.1", "0.2", "0.3", "1.7976931348623157e308", "2.2250738585072014e-308", "4.9e-324",
+        "12.375641876", "3.141592653589793238462643383279", "123456789012345678901234567890",
+        "9007199254740993", "0.000000000000000000000000000001", "1e22", "1e23", "7.2057594037927933e16",
+        "2.5e-10", "123.456e-7", "99999999999999999999e-20", "1.0000000000000002", "5e-324"
+    };
+
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(*numbers); ++i)
+    {
+        double value = 0;
+        EXPECT_TRUE(sclap::hidden::toDouble(numbers[i], value)) << numbers[i];
+        EXPECT_EQ(value, strtod(numbers[i], NULL)) << numbers[i];
+    }
+
+    srand(12345);
+    for (int i = 0; i < 10000; ++i)
+    {
+        char number[64];
+        snprintf(number, sizeof(number), "%d.%de%d", rand() % 100000, rand(), rand() % 60 - 30);
+
+        double value = 0;
+        EXPECT_TRUE(sclap::hidden::toDouble(number, value)) << number;
+        EXPECT_EQ(value, strtod(number, NULL)) << number;
+    }
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(NumberTest, DigitRuns)
+{
+    const char eight[] = "12345678";
+    EXPECT_FALSE(sclap::hidden::isEightDigits("1234567a"));
+    EXPECT_FALSE(sclap::hidden::isEightDigits("/2345678"));
+    EXPECT_FALSE(sclap::hidden::isEightDigits("1234:678"));
+    // false everywhere without the word kernel (SCLAP_NO_SIMD, big endian)
+    if (sclap::hidden::isEightDigits(eight))
+    {
+        EXPECT_EQ(sclap::hidden::parseEightDigits(eight), 12345678u);
+        EXPECT_EQ(sclap::hidden::parseEightDigits("09000001"), 9000001u);
+    }
+
+    // every digit run length, with and without leading zeros, bit exact to the C library
+    srand(4321);
+    for (int i = 0; i < 20000; ++i)
+    {
+        const int digits = 1 + i % 19;
+        char number[64];
+        int length = 0;
+        if (i % 3 == 0) number[length++] = '-';
+        if (i % 7 == 0) { number[length++] = '0'; number[length++] = '0'; }
+        for (int d = 0; d < digits; ++d)
+        {
+            number[length++] = (char)('0' + rand() % 10);
+        }
+        number[length] = '\0';
+
+        long long integerValue = 0;
+        const sclap::hidden::NumberResult res =
+            sclap::hidden::parseInteger(number, number + length, integerValue);
+        errno = 0;
+        const long long expected = strtoll(number, NULL, 10);
+        if (errno == ERANGE)
+        {
+            EXPECT_EQ(res.ec, std::errc::result_out_of_range) << number;
+        }
+        else
+        {
+            EXPECT_EQ(res.ec, std::errc()) << number;
+            EXPECT_EQ(integerValue, expected) << number;
+        }
+
+        // the same digits split by a point and with an exponent
+        char real[80];
+        const int point = rand() % (digits + 1);
+        snprintf(real, sizeof(real), "%.*s.%se%d", length - digits + point, number,
+            number + length - digits + point, rand() % 40 - 20);
+
+        double realValue = 0;
+        EXPECT_TRUE(sclap::hidden::toDouble(real, realValue)) << real;
+        const double expectedReal = strtod(real, NULL);
+        EXPECT_EQ(memcmp(&realValue, &expectedReal, sizeof(double)), 0) << real;
+    }
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(NumberTest, BulkVectors)
+{
+    std::vector<std::string> arguments;
+    arguments.push_back("Program Name");
+    arguments.push_back("--ints=123456789");
+    for (int i = 1; i < 10000; ++i)
+    {
+        arguments.push_back(std::to_string(i * 7919LL * (i % 2 ? 1 : 104729) % 2147483647));
+    }
+    arguments.push_back("-r");
+    for (int i = 0; i < 10000; ++i)
+    {
+        arguments.push_back(std::to_string(i * 31) + "." + std::to_string(i * 7919LL % 100000000) + "e-3");
+    }
+
+    std::vector<char*> argv;
+    for (size_t i = 0; i < arguments.size(); ++i)
+    {
+        argv.push_back(&arguments[i][0]);
+    }
+    argv.push_back(NULL);
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('i', "ints", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('r', "reals", sclap::ARG_REAL_VEC);
+
+    sclap::Options options(descriptors, (int)argv.size() - 1, argv.data());
+    ASSERT_TRUE(options.valid());
+
+    const sclap::Span<int> ints = options['i'].asIntegerSpan();
+    ASSERT_EQ(ints.size(), 10000u);
+    EXPECT_EQ(ints[0], 123456789);
+    for (size_t i = 1; i < ints.size(); ++i)
+    {
+        int expected = 0;
+        sclap::hidden::toInteger(arguments[i + 1].c_str(), expected);
+        EXPECT_EQ(ints[i], expected) << arguments[i + 1];
+    }
+
+    const sclap::Span<double> reals = options['r'].asRealSpan();
+    ASSERT_EQ(reals.size(), 10000u);
+    for (size_t i = 0; i < reals.size(); ++i)
+    {
+        const double expected = strtod(arguments[i + 10002].c_str(), NULL);
+        EXPECT_EQ(memcmp(&reals[i], &expected, sizeof(double)), 0) << arguments[i + 10002];
+    }
+
+    // a bad element fails the option instead of being skipped
+    char* bad[] = { "Program Name", "-r", "1.5", "x", NULL };
+    EXPECT_FALSE(sclap::Options(descriptors, 4, bad).valid());
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(SpanTest, Vectors)
+{
+    int argc = 8;
+    char* argv[8];
+    argv[0] = "Program Name";
+    argv[1] = "-t";
+    argv[2] = "12";
+    argv[3] = "0";
+    argv[4] = "--real";
+    argv[5] = "1.5";
+    argv[6] = "--flags";
+    argv[7] = "false";
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('t', "test", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL_VEC)
+                << sclap::OptionDescriptor('f', "flags", sclap::ARG_BOOL_VEC);
+
+    sclap::Options options(descriptors, argc, argv);
+    EXPECT_TRUE(options.valid());
+
+    sclap::Span<int> ints = options['t'].asIntegerSpan();
+    ASSERT_EQ(ints.size(), 2u);
+    EXPECT_EQ(ints[0], 12);
+    EXPECT_EQ(ints[1], 0);
+
+    // converted once, later calls return the same storage
+    sclap::Span<double> reals = options['t'].asRealSpan();
+    ASSERT_EQ(reals.size(), 2u);
+    EXPECT_EQ(reals[0], 12.0);
+    EXPECT_EQ(options['t'].asRealSpan().data(), reals.data());
+
+    sclap::Span<bool> bools = options['t'].asBoolSpan();
+    ASSERT_EQ(bools.size(), 2u);
+    EXPECT_TRUE(bools[0]);
+    EXPECT_FALSE(bools[1]);
+    EXPECT_EQ(options['t'].asBoolSpan().data(), bools.data());
+
+    EXPECT_EQ(options['r'].asRealSpan().size(), 1u);
+    EXPECT_EQ(options['r'].asRealSpan()[0], 1.5);
+    EXPECT_TRUE(options['r'].asIntegerSpan().empty());
+
+    ASSERT_EQ(options['f'].asBoolSpan().size(), 1u);
+    EXPECT_FALSE(options['f'].asBoolSpan()[0]);
+
+    EXPECT_TRUE(options['x'].asIntegerSpan().empty());
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(SpanTest, Scalars)
+{
+    char* argv[] = { "Program Name", "-t", "12", "--real", "2.5", "-f", "-l", "5000000000",
+                     "-b", "true", "false", NULL };
+    int argc = 11;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('t', "test", sclap::ARG_INT)
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL)
+                << sclap::OptionDescriptor('f', "flag", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('l', "long", sclap::ARG_INT64)
+                << sclap::OptionDescriptor('b', "bools", sclap::ARG_BOOL_VEC);
+
+    sclap::Options options(descriptors, argc, argv);
+    EXPECT_TRUE(options.valid());
+
+    ASSERT_EQ(options['t'].asIntegerSpan().size(), 1u);
+    EXPECT_EQ(options['t'].asIntegerSpan()[0], 12);
+    EXPECT_EQ(options['t'].asRealSpan()[0], 12.0);
+    EXPECT_TRUE(options['t'].asBoolSpan()[0]);
+
+    ASSERT_EQ(options['r'].asRealSpan().size(), 1u);
+    EXPECT_EQ(options['r'].asRealSpan()[0], 2.5);
+    // no narrowed int or bool views, like the vectors
+    EXPECT_TRUE(options['r'].asIntegerSpan().empty());
+    EXPECT_TRUE(options['r'].asBoolSpan().empty());
+
+    ASSERT_EQ(options['f'].asBoolSpan().size(), 1u);
+    EXPECT_TRUE(options['f'].asBoolSpan()[0]);
+
+    ASSERT_EQ(options['l'].asRealSpan().size(), 1u);
+    EXPECT_EQ(options['l'].asRealSpan()[0], 5000000000.0);
+    EXPECT_TRUE(options['l'].asIntegerSpan().empty());
+    ASSERT_EQ(options['l'].asBoolSpan().size(), 1u);
+    EXPECT_TRUE(options['l'].asBoolSpan()[0]);
+
+    ASSERT_EQ(options['b'].asBoolSpan().size(), 2u);
+    EXPECT_TRUE(options['b'].asIntegerSpan().empty());
+    EXPECT_TRUE(options['b'].asRealSpan().empty());
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+template <typename T>
+void expectSpanMatches(sclap::Span<T> span, const std::vector<T>& vector, const char* what)
+{
+    ASSERT_EQ(span.size(), vector.size()) << what;
+    for (size_t i = 0; i < vector.size(); ++i)
+    {
+        EXPECT_EQ(span[i], vector[i]) << what << " " << i;
+    }
+}
+
+TEST(SpanTest, MatchesVectors)
+{
+    char* argv[] = { "Program Name", "-b", "-i", "7", "-r", "1e20", "-s", "text",
+                     "-B", "true", "false", "-I", "3", "0", "-R", "0.5", "5",
+                     "-S", "x", "y", "-l", "-9000000000", "-u", "18446744073709551615",
+                     "-z", "4K", "-F", "0.25", "2", NULL };
+    int argc = 29;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('b', "bool", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('i', "int", sclap::ARG_INT)
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL)
+                << sclap::OptionDescriptor('s', "string", sclap::ARG_STRING)
+                << sclap::OptionDescriptor('B', "bools", sclap::ARG_BOOL_VEC)
+                << sclap::OptionDescriptor('I', "ints", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('R', "reals", sclap::ARG_REAL_VEC)
+                << sclap::OptionDescriptor('S', "strings", sclap::ARG_STRING_VEC)
+                << sclap::OptionDescriptor('l', "long", sclap::ARG_INT64)
+                << sclap::OptionDescriptor('u', "unsigned", sclap::ARG_UINT64)
+                << sclap::OptionDescriptor('z', "size", sclap::ARG_SIZE)
+                << sclap::OptionDescriptor('F', "floats", sclap::ARG_FLOAT_VEC);
+    const char names[] = "birsBIRSluzFx";
+
+    const uint32_t flags[] = { sclap::PARSE_DEFAULT, sclap::PARSE_LAZY };
+    for (size_t f = 0; f < sizeof(flags) / sizeof(*flags); ++f)
+    {
+        sclap::Options options(descriptors, argc, argv, NULL, flags[f]);
+        ASSERT_TRUE(options.valid()) << options.error();
+
+        for (size_t i = 0; names[i]; ++i)
+        {
+            const sclap::Option& option = options[names[i]];
+            const std::string what(1, names[i]);
+            expectSpanMatches(option.asBoolSpan(), option.asBoolVector(), what.c_str());
+            expectSpanMatches(option.asIntegerSpan(), option.asIntegerVector(), what.c_str());
+            expectSpanMatches(option.asRealSpan(), option.asRealVector(), what.c_str());
+            expectSpanMatches(option.asFloatSpan(), option.asFloatVector(), what.c_str());
+        }
+
+        // narrowed on access, saturated instead of out of range casts
+        EXPECT_EQ(options['r'].asInteger(), std::numeric_limits<int>::max());
+        EXPECT_EQ(options['r'].asInt64(), std::numeric_limits<int64_t>::max());
+        EXPECT_EQ(options['l'].asInteger(), std::numeric_limits<int>::min());
+        EXPECT_EQ(options['u'].asInteger(), std::numeric_limits<int>::max());
+        EXPECT_EQ(options['z'].asInteger(), 4096);
+    }
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(ResponseFileTest, Tokenize)
+{
+    char text[] = "  plain 'single quoted \\' \"double \\\"quoted\\\"\"\tesc\\ aped\n\"\" x\"y z\"";
+    char* cur = text;
+    char* end = text + sizeof(text) - 1;
+
+    std::vector<std::string> tokens;
+    while (char* token = sclap::hidden::nextToken(cur, end))
+    {
+        tokens.push_back(token);
+    }
+
+    ASSERT_EQ(tokens.size(), 6u);
+    EXPECT_EQ(tokens[0], "plain");
+    EXPECT_EQ(tokens[1], "single quoted \\");
+    EXPECT_EQ(tokens[2], "double \"quoted\"");
+    EXPECT_EQ(tokens[3], "esc aped");
+    EXPECT_EQ(tokens[4], "");
+    EXPECT_EQ(tokens[5], "xy z");
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(ResponseFileTest, TokenBreaks)
+{
+    // every character class at every offset of the vector width
+    const char alphabet[] = "ab-=0 \t\n\r\v\f'\"\\\x80\xff\x08\x0e";
+    std::string text;
+    for (int i = 0; i < 4096; ++i)
+    {
+        text.push_back(alphabet[(i * 7919 + i / 13) % (sizeof(alphabet) - 1)]);
+        if (i % 5) text.append(i % 37, 'x');
+    }
+
+    const char* end = text.data() + text.size();
+    for (size_t i = 0; i < text.size(); i += 3)
+    {
+        const char* cur = text.data() + i;
+        ASSERT_EQ(sclap::hidden::findTokenBreak(cur, end), sclap::hidden::findTokenBreakScalar(cur, end));
+    }
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(ResponseFileTest, CommandLineString)
+{
+    const std::string longWord(100, 'w');
+    const std::string text = "prog --name \"two  words\" -i 1 2 3 --path=" + longWord + "\\ " + longWord
+        + " '-'\"f\" --real=1.5  ";
+    std::vector<char> line(text.begin(), text.end());
+    line.push_back('\0');
+
+    sclap::CommandLineArguments arguments(line.data(), text.size());
+    ASSERT_EQ(arguments.argc(), 10);
+    EXPECT_EQ(arguments.argv()[arguments.argc()], (char*)NULL);
+    EXPECT_STREQ(arguments.argv()[0], "prog");
+    EXPECT_STREQ(arguments.argv()[2], "two  words");
+    EXPECT_EQ(std::string(arguments.argv()[7]), "--path=" + longWord + " " + longWord);
+    EXPECT_STREQ(arguments.argv()[8], "-f");
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('n', "name", sclap::ARG_STRING)
+                << sclap::OptionDescriptor('i', "ints", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('p', "path", sclap::ARG_STRING)
+                << sclap::OptionDescriptor('f', "flag", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL);
+
+    sclap::Options options(descriptors, arguments.argc(), arguments.argv());
+    EXPECT_TRUE(options.valid());
+    EXPECT_EQ(options['n'].asString(), "two  words");
+    EXPECT_EQ(options['i'].asIntegerVector(), std::vector<int>({ 1, 2, 3 }));
+    EXPECT_EQ(options["path"].asString(), longWord + " " + longWord);
+    EXPECT_TRUE(options['f'].asBool());
+    EXPECT_EQ(options['r'].asDouble(), 1.5);
+
+    char empty[] = "";
+    EXPECT_EQ(sclap::CommandLineArguments(empty).argc(), 0);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(ResponseFileTest, Expand)
+{
+    const char* path = "sclap_response_test.rsp";
+    {
+        std::ofstream file(path);
+        file << "--name 'two words'\n-i 1 2 3\n";
+    }
+
+    int argc = 4;
+    char* argv[5];
+    argv[0] = "Program Name";
+    argv[1] = "-f";
+    argv[2] = "@sclap_response_test.rsp";
+    argv[3] = "--real=1.5";
+    argv[4] = NULL;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('f', "flag", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('n', "name", sclap::ARG_STRING)
+                << sclap::OptionDescriptor('i', "ints", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL);
+
+    {
+        sclap::Options options(descriptors, argc, argv, NULL,
+            sclap::PARSE_RESPONSE_FILES | sclap::PARSE_ZERO_COPY);
+        EXPECT_TRUE(options.valid());
+        EXPECT_TRUE(options['f'].asBool());
+        EXPECT_EQ(options['n'].asStringView(), "two words");
+        EXPECT_EQ(options['i'].asIntegerVector(), std::vector<int>({ 1, 2, 3 }));
+        EXPECT_EQ(options['r'].asDouble(), 1.5);
+    }
+
+    // not expanded by default
+    {
+        sclap::Options options(descriptors, argc, argv);
+        EXPECT_FALSE(options.valid());
+    }
+
+    std::remove(path);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(ResponseFileTest, MissingFile)
+{
+    int argc = 2;
+    char* argv[3];
+    argv[0] = "Program Name";
+    argv[1] = "@sclap_missing_file.rsp";
+    argv[2] = NULL;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('f', "flag", sclap::ARG_BOOL);
+
+    sclap::Options options(descriptors, argc, argv, NULL, sclap::PARSE_RESPONSE_FILES);
+    EXPECT_FALSE(options.valid());
+    EXPECT_NE(options.error().find("sclap_missing_file.rsp"), std::string::npos);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+class RecordingVisitor : public sclap::OptionVisitor
+{
+public:
+    RecordingVisitor(size_t limit = 1000) : mLimit(limit) {}
+
+    std::vector<std::string> events;
+
+    virtual bool onOption(const sclap::DescriptorView& option)
+    {
+        return add("option " + option.longNameView().str());
+    }
+
+    virtual bool onBool(const sclap::DescriptorView& option, bool value)
+    {
+        return add(option.longNameView().str() + (value ? " true" : " false"));
+    }
+
+    virtual bool onInteger(const sclap::DescriptorView& option, int value)
+    {
+        return add(option.longNameView().str() + " " + std::to_string(value));
+    }
+
+    virtual bool onReal(const sclap::DescriptorView& option, double value)
+    {
+        return add(option.longNameView().str() + " " + std::to_string(value));
+    }
+
+    virtual bool onString(const sclap::DescriptorView& option, sclap::StringView value)
+    {
+        return add(option.longNameView().str() + " " + value.str());
+    }
+
+private:
+    size_t mLimit;
+
+    bool add(const std::string& event)
+    {
+        events.push_back(event);
+        return events.size() < mLimit;
+    }
+};
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(VisitorTest, Events)
+{
+    int argc = 11;
+    char* argv[12];
+    argv[0] = "Program Name";
+    argv[1] = "-fi";
+    argv[2] = "1";
+    argv[3] = "2";
+    argv[4] = "--name=text";
+    argv[5] = "--real";
+    argv[6] = "1.5";
+    argv[7] = "-f";
+    argv[8] = "false";
+    argv[9] = "--bools";
+    argv[10] = "True";
+    argv[11] = NULL;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('f', "flag", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('i', "ints", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('n', "name", sclap::ARG_STRING)
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL)
+                << sclap::OptionDescriptor('b', "bools", sclap::ARG_BOOL_VEC);
+
+    RecordingVisitor visitor;
+    EXPECT_TRUE(sclap::visitOptions(descriptors, argc, argv, visitor));
+
+    const char* expected[] = {
+        "option flag", "option ints", "flag 1", "ints 1", "flag 2", "ints 2",
+        "option name", "name text",
+        "option real", "real 1.500000",
+        "option flag", "flag false",
+        "option bools", "bools true"
+    };
+    EXPECT_EQ(visitor.events, std::vector<std::string>(expected,
+        expected + sizeof(expected) / sizeof(*expected)));
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(VisitorTest, StopAndErrors)
+{
+    int argc = 5;
+    char* argv[6];
+    argv[0] = "Program Name";
+    argv[1] = "-i";
+    argv[2] = "1";
+    argv[3] = "2";
+    argv[4] = "x";
+    argv[5] = NULL;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('i', "ints", sclap::ARG_INT_VEC);
+
+    // stopped by the visitor
+    RecordingVisitor stopping(2);
+    sclap::Error error = { sclap::ERROR_RESPONSE_FILE, "", 0, 0 };
+    EXPECT_FALSE(sclap::visitOptions(descriptors, argc, argv, stopping, &error));
+    EXPECT_EQ(stopping.events.size(), 2u);
+    EXPECT_EQ(error.code, sclap::ERROR_RESPONSE_FILE);
+
+    // values before the malformed one are reported
+    RecordingVisitor visitor;
+    EXPECT_FALSE(sclap::visitOptions(descriptors, argc, argv, visitor, &error));
+    EXPECT_EQ(visitor.events.size(), 3u);
+    EXPECT_EQ(error.code, sclap::ERROR_READ_ARGUMENT);
+    EXPECT_EQ(error.subject, "x");
+    EXPECT_EQ(error.argumentIndex, 4);
+
+    argv[1] = "-x";
+    EXPECT_FALSE(sclap::visitOptions(descriptors, argc, argv, visitor, &error));
+    EXPECT_EQ(error.code, sclap::ERROR_UNKNOWN_SHORT_OPTION);
+    EXPECT_EQ(error.subject, "x");
+    EXPECT_EQ(error.offset, 1u);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(VisitorTest, FloatRange)
+{
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('w', "weights", sclap::ARG_FLOAT_VEC)
+                << sclap::OptionDescriptor('p', "packed", sclap::ARG_FLOAT_VEC, ',')
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL);
+
+    // the visitor accepts and rejects the same floats as Options
+    char* cases[][4] = {
+        { "Program Name", "-w", "0.5", "1e30" },
+        { "Program Name", "-w", "0.5", "1e300" },
+        { "Program Name", "-w", "-1e39", "2" },
+        { "Program Name", "--packed=1,2.5", "-r", "1e300" },
+        { "Program Name", "--packed=1,1e300", "-r", "1" },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(*cases); ++i)
+    {
+        char* argv[5] = { cases[i][0], cases[i][1], cases[i][2], cases[i][3], NULL };
+        sclap::Options options(descriptors, 4, argv);
+
+        RecordingVisitor visitor;
+        sclap::Error error = { sclap::ERROR_RESPONSE_FILE, "", 0, 0 };
+        EXPECT_EQ(sclap::visitOptions(descriptors, 4, argv, visitor, &error), options.valid()) << i;
+        if (!options.valid())
+        {
+            ASSERT_EQ(options.errors().size(), 1u);
+            EXPECT_EQ(error.code, options.errors()[0].code) << i;
+        }
+    }
+
+    // the visitor reports the element out of range
+    char* argv[] = { "Program Name", "-w", "0.5", "1e300", NULL };
+    RecordingVisitor visitor;
+    sclap::Error error = { sclap::ERROR_RESPONSE_FILE, "", 0, 0 };
+    EXPECT_FALSE(sclap::visitOptions(descriptors, 4, argv, visitor, &error));
+    EXPECT_EQ(error.subject, "1e300");
+    EXPECT_EQ(error.argumentIndex, 3);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(LazyTest, ConvertOnAccess)
+{
+    int argc = 11;
+    char* argv[12];
+    argv[0] = "Program Name";
+    argv[1] = "-f";
+    argv[2] = "--ints=1";
+    argv[3] = "2";
+    argv[4] = "3";
+    argv[5] = "--real";
+    argv[6] = "x";
+    argv[7] = "--name";
+    argv[8] = "text";
+    argv[9] = "-b";
+    argv[10] = "false";
+    argv[11] = NULL;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('f', "flag", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('i', "ints", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL)
+                << sclap::OptionDescriptor('n', "name", sclap::ARG_STRING)
+                << sclap::OptionDescriptor('b', "bool", sclap::ARG_BOOL);
+
+    // converted eagerly the malformed real fails the parse
+    {
+        sclap::Options options(descriptors, argc, argv);
+        EXPECT_FALSE(options.valid());
+    }
+
+    sclap::Options options(descriptors, argc, argv, NULL, sclap::PARSE_LAZY);
+    EXPECT_TRUE(options.valid());
+
+    EXPECT_TRUE(options['f'].asBool());
+    EXPECT_EQ(options['i'].type(), sclap::ARG_INT_VEC);
+    EXPECT_EQ(options['i'].asIntegerVector(), std::vector<int>({ 1, 2, 3 }));
+    EXPECT_EQ(options['i'].asIntegerSpan().data(), options['i'].asIntegerSpan().data());
+    EXPECT_TRUE(options['i'].valid());
+    EXPECT_EQ(options['n'].asString(), "text");
+    EXPECT_FALSE(options['b'].asBool());
+
+    // the error is reported on access
+    EXPECT_EQ(options['r'].type(), sclap::ARG_REAL);
+    EXPECT_FALSE(options['r'].valid());
+    EXPECT_NE(options['r'].error().find("x"), std::string::npos);
+    EXPECT_EQ(options['r'].asDouble(), 0);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(LazyTest, SameResultsAsEager)
+{
+    int argc = 10;
+    char* argv[11];
+    argv[0] = "Program Name";
+    argv[1] = "-tb";
+    argv[2] = "12";
+    argv[3] = "0";
+    argv[4] = "--strings";
+    argv[5] = "a";
+    argv[6] = "b";
+    argv[7] = "-r";
+    argv[8] = "-1.5";
+    argv[9] = "-f";
+    argv[10] = NULL;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('t', "test", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('b', "bools", sclap::ARG_BOOL_VEC)
+                << sclap::OptionDescriptor('s', "strings", sclap::ARG_STRING_VEC)
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL)
+                << sclap::OptionDescriptor('f', "flag", sclap::ARG_BOOL);
+
+    sclap::Options eager(descriptors, argc, argv);
+    sclap::Options lazy(descriptors, argc, argv, NULL, sclap::PARSE_LAZY);
+    ASSERT_TRUE(eager.valid());
+    ASSERT_TRUE(lazy.valid());
+
+    const char names[] = "tbsrf";
+    for (size_t i = 0; i < sizeof(names) - 1; ++i)
+    {
+        const char name = names[i];
+        EXPECT_EQ(eager[name].type(), lazy[name].type());
+        EXPECT_EQ(eager[name].asIntegerVector(), lazy[name].asIntegerVector());
+        EXPECT_EQ(eager[name].asRealVector(), lazy[name].asRealVector());
+        EXPECT_EQ(eager[name].asBoolVector(), lazy[name].asBoolVector());
+        EXPECT_EQ(eager[name].asStringVector(), lazy[name].asStringVector());
+        EXPECT_EQ(eager[name].asDouble(), lazy[name].asDouble());
+        EXPECT_EQ(eager[name].asBool(), lazy[name].asBool());
+    }
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(LookupTest, IndexedOptions)
+{
+    sclap::OptionDescriptors descriptors;
+    std::vector<std::string> arguments;
+    arguments.push_back("Program Name");
+    for (int i = 0; i < 200; ++i)
+    {
+        const std::string name = "option-" + std::to_string(i);
+        descriptors << sclap::OptionDescriptor(i < 26 ? 'a' + i : sclap::OPT_SHORT_NONE,
+            name.c_str(), sclap::ARG_INT);
+        arguments.push_back("--" + name);
+        arguments.push_back(std::to_string(i));
+    }
+    // repeated option, the first occurrence is found
+    arguments.push_back("-c");
+    arguments.push_back("1000");
+
+    std::vector<char*> argv;
+    for (size_t i = 0; i < arguments.size(); ++i)
+    {
+        argv.push_back(&arguments[i][0]);
+    }
+    argv.push_back(NULL);
+
+    sclap::Options options(descriptors, (int)arguments.size(), argv.data());
+    EXPECT_TRUE(options.valid());
+
+    for (int i = 0; i < 200; ++i)
+    {
+        const std::string name = "option-" + std::to_string(i);
+        EXPECT_EQ(options[name].asInteger(), i);
+        EXPECT_EQ(options[name.c_str()].asInteger(), i);
+        EXPECT_EQ(options[name].longNameView(), name);
+    }
+
+    EXPECT_EQ(options['c'].asInteger(), 2);
+    EXPECT_EQ(options["c"].asInteger(), 2);
+    EXPECT_EQ(options['z'].asInteger(), 25);
+
+    EXPECT_EQ(options['Z'].type(), sclap::UNEXISTED);
+    EXPECT_EQ(options[sclap::OPT_SHORT_NONE].type(), sclap::UNEXISTED);
+    EXPECT_EQ(options["option-200"].type(), sclap::UNEXISTED);
+    EXPECT_EQ(options[""].type(), sclap::UNEXISTED);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(ReadNamesTest, ResolvedDescriptors)
+{
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('a', "alpha", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('b', "beta", sclap::ARG_INT)
+                << sclap::OptionDescriptor('c', "gamma", sclap::ARG_BOOL);
+
+    char cluster[] = "-cab";
+    char longOption[] = "--beta=1";
+    char duplicate[] = "-aba";
+    char unknown[] = "--delta";
+    char* argv[] = { cluster, longOption, duplicate, unknown, NULL };
+
+    sclap::hidden::ArgumentOptions options;
+    sclap::Error error;
+    int index = 0;
+    char* cur = argv[0];
+
+    // in the order of appearance
+    ASSERT_TRUE(sclap::hidden::readOptionNames(descriptors, index, &cur, argv, options, error));
+    ASSERT_EQ(options.size, 3u);
+    EXPECT_EQ(options.descriptors[0], descriptors['c']);
+    EXPECT_EQ(options.descriptors[1], descriptors['a']);
+    EXPECT_EQ(options.descriptors[2], descriptors['b']);
+    EXPECT_EQ(index, 1);
+    EXPECT_EQ(cur, argv[1]);
+
+    // the value follows '='
+    ASSERT_TRUE(sclap::hidden::readOptionNames(descriptors, index, &cur, argv, options, error));
+    ASSERT_EQ(options.size, 1u);
+    EXPECT_EQ(options.descriptors[0], descriptors["beta"]);
+    EXPECT_EQ(index, 1);
+    EXPECT_STREQ(cur, "1");
+
+    index = 2;
+    cur = argv[2];
+    EXPECT_FALSE(sclap::hidden::readOptionNames(descriptors, index, &cur, argv, options, error));
+    EXPECT_EQ(error.code, sclap::ERROR_REPEATED_SHORT_OPTION);
+    EXPECT_EQ(error.offset, 3u);
+
+    index = 3;
+    cur = argv[3];
+    EXPECT_FALSE(sclap::hidden::readOptionNames(descriptors, index, &cur, argv, options, error));
+    EXPECT_EQ(error.code, sclap::ERROR_NOT_AN_OPTION);
+    EXPECT_EQ(error.subject, "delta");
+    EXPECT_EQ(error.offset, 2u);
+    EXPECT_EQ(index, 3);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(ErrorTest, Records)
+{
+    int argc = 5;
+    char* argv[6];
+    argv[0] = "Program Name";
+    argv[1] = "-f";
+    argv[2] = "--ints";
+    argv[3] = "1";
+    argv[4] = "--name=";
+    argv[5] = NULL;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('f', "flag", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('i', "ints", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('n', "name", sclap::ARG_STRING)
+                << sclap::OptionDescriptor('x', "x", sclap::ARG_BOOL);
+
+    ASSERT_EQ(descriptors.errors().size(), 1u);
+    EXPECT_EQ(descriptors.errors()[0].code, sclap::ERROR_LONG_NAME_LENGTH);
+    EXPECT_EQ(descriptors.errors()[0].subject, "x");
+    EXPECT_EQ(descriptors.error(), "Long option length cant be 1: x.\n");
+
+    // the empty value of --name=
+    sclap::Options options(descriptors, argc, argv);
+    EXPECT_FALSE(options.valid());
+    ASSERT_EQ(options.errors().size(), 1u);
+    EXPECT_EQ(options.errors()[0].code, sclap::ERROR_READ_ARGUMENT);
+    EXPECT_EQ(options.errors()[0].argumentIndex, 4);
+    EXPECT_EQ(options.errors()[0].offset, 7u);
+    EXPECT_EQ(options.error(), options.errors()[0].str());
+
+    argv[2] = "--int";
+    sclap::Options unknown(descriptors, argc, argv);
+    EXPECT_FALSE(unknown.valid());
+    EXPECT_EQ(unknown.errors()[0].code, sclap::ERROR_NOT_AN_OPTION);
+    EXPECT_EQ(unknown.errors()[0].argumentIndex, 2);
+    EXPECT_EQ(unknown.errors()[0].str(), "Error: int. Is not an option.\n");
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(CompiledTest, Shared)
+{
+    int argc = 5;
+    char* argv[6];
+    argv[0] = "Program Name";
+    argv[1] = "-t";
+    argv[2] = "12";
+    argv[3] = "--name";
+    argv[4] = "text";
+    argv[5] = NULL;
+
+    std::shared_ptr<const sclap::CompiledDescriptors> compiled;
+    {
+        sclap::OptionDescriptors descriptors;
+        descriptors << sclap::OptionDescriptor('t', "test", sclap::ARG_INT)
+                    << sclap::OptionDescriptor('n', "name", sclap::ARG_STRING)
+                    << sclap::OptionDescriptor('t', "other", sclap::ARG_REAL);
+        compiled = descriptors.compile();
+    }
+
+    ASSERT_EQ(compiled->size(), 3u);
+    EXPECT_TRUE(compiled->valid());
+    EXPECT_EQ((*compiled)['t']->longName(), "test");
+    EXPECT_EQ((*compiled)["other"]->longName(), "other");
+    EXPECT_EQ((*compiled)["none"], (const sclap::OptionDescriptor*)NULL);
+
+    {
+        sclap::Options first(compiled, argc, argv);
+        sclap::Options second(compiled, argc, argv);
+        EXPECT_EQ(compiled.use_count(), 3);
+
+        EXPECT_TRUE(first.valid());
+        EXPECT_TRUE(second.valid());
+        EXPECT_EQ(first['t'].asInteger(), 12);
+        EXPECT_EQ(second["name"].asString(), "text");
+    }
+    EXPECT_EQ(compiled.use_count(), 1);
+
+    // referenced without sharing ownership
+    sclap::Options options(*compiled, argc, argv);
+    EXPECT_EQ(options["test"].asInteger(), 12);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(BatchTest, ParseBatch)
+{
+    char* valid[] = { "Program Name", "-t", "12", "--name", "text", NULL };
+    char* invalid[] = { "Program Name", "-t", "text", NULL };
+    char* empty[] = { "Program Name", NULL };
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('t', "test", sclap::ARG_INT)
+                << sclap::OptionDescriptor('n', "name", sclap::ARG_STRING);
+    std::shared_ptr<const sclap::CompiledDescriptors> compiled = descriptors.compile();
+
+    std::vector<sclap::CommandLine> commandLines;
+    for (int i = 0; i < 1000; ++i)
+    {
+        sclap::CommandLine commandLine = { 5, valid };
+        if (i % 3 == 1) { commandLine.argc = 3; commandLine.argv = invalid; }
+        if (i % 3 == 2) { commandLine.argc = 1; commandLine.argv = empty; }
+        commandLines.push_back(commandLine);
+    }
+
+    const unsigned threadCounts[] = { 1, 4, 0 };
+    for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t)
+    {
+        std::vector<std::unique_ptr<sclap::Options> > results =
+            sclap::parseBatch(*compiled, commandLines, threadCounts[t]);
+
+        ASSERT_EQ(results.size(), commandLines.size());
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            ASSERT_TRUE(results[i] != NULL);
+            const sclap::Options& options = *results[i];
+            if (i % 3 == 0)
+            {
+                EXPECT_TRUE(options.valid());
+                EXPECT_EQ(options['t'].asInteger(), 12);
+                EXPECT_EQ(options["name"].asString(), "text");
+            }
+            else if (i % 3 == 1)
+            {
+                EXPECT_FALSE(options.valid());
+            }
+            else
+            {
+                EXPECT_TRUE(options.valid());
+                EXPECT_EQ(options['t'].type(), sclap::UNEXISTED);
+            }
+        }
+    }
+
+    EXPECT_TRUE(sclap::parseBatch(*compiled, std::vector<sclap::CommandLine>()).empty());
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(PackedListTest, AllTypes)
+{
+    int argc = 11;
+    char* argv[12];
+    argv[0] = "Program Name";
+    argv[1] = "--ints=-1,2,3";
+    argv[2] = "-r";
+    argv[3] = "0.5:0.25:-1e3";
+    argv[4] = "--bools=true,False";
+    argv[5] = "--names";
+    argv[6] = "a,bc,d e";
+    argv[7] = "--unpacked";
+    argv[8] = "1,2";
+    argv[9] = "--spread";
+    argv[10] = "4";
+    argv[11] = NULL;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('i', "ints", sclap::ARG_INT_VEC, ',')
+                << sclap::OptionDescriptor('r', "reals", sclap::ARG_REAL_VEC, ':')
+                << sclap::OptionDescriptor('b', "bools", sclap::ARG_BOOL_VEC, ',')
+                << sclap::OptionDescriptor('n', "names", sclap::ARG_STRING_VEC, ',')
+                << sclap::OptionDescriptor('u', "unpacked", sclap::ARG_STRING_VEC)
+                << sclap::OptionDescriptor('s', "spread", sclap::ARG_INT_VEC, ',');
+
+    const uint32_t flags[] = { sclap::PARSE_DEFAULT, sclap::PARSE_ZERO_COPY, sclap::PARSE_LAZY };
+    for (size_t f = 0; f < sizeof(flags) / sizeof(*flags); ++f)
+    {
+        sclap::Options options(descriptors, argc, argv, NULL, flags[f]);
+        ASSERT_TRUE(options.valid()) << options.error();
+        EXPECT_EQ(options['i'].asIntegerVector(), std::vector<int>({ -1, 2, 3 }));
+        EXPECT_EQ(options['r'].asRealVector(), std::vector<double>({ 0.5, 0.25, -1e3 }));
+        EXPECT_EQ(options['b'].asBoolVector(), std::vector<bool>({ true, false }));
+        EXPECT_EQ(options['n'].asStringVector(), std::vector<std::string>({ "a", "bc", "d e" }));
+        EXPECT_EQ(options['u'].asStringVector(), std::vector<std::string>({ "1,2" }));
+        EXPECT_EQ(options['s'].asIntegerVector(), std::vector<int>({ 4 }));
+    }
+
+    // empty elements and bad values fail the option
+    char* empty[] = { "Program Name", "--ints=1,,2", NULL };
+    EXPECT_FALSE(sclap::Options(descriptors, 2, empty).valid());
+    char* bad[] = { "Program Name", "--reals=1:x", NULL };
+    EXPECT_FALSE(sclap::Options(descriptors, 2, bad).valid());
+    // not attached, so it is an option
+    char* option[] = { "Program Name", "-i", "-1,2", NULL };
+    EXPECT_FALSE(sclap::Options(descriptors, 3, option).valid());
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+constexpr sclap::SchemaOption kPackedOptions[] = {
+    sclap::SchemaOption('i', "ids", sclap::ARG_INT_VEC, ',')
+};
+
+static_assert(kPackedOptions[0].listDelimiter() == ',', "Delimiters are known at compile time.");
+
+TEST(PackedListTest, Ranges)
+{
+    int argc = 2;
+    char* argv[3];
+    argv[0] = "Program Name";
+    argv[1] = "--ids=7,1-5,-2--1,3-3,2147483646-2147483647,0-999999";
+    argv[2] = NULL;
+
+    const sclap::Schema<1, kPackedOptions> schema;
+
+    sclap::Options options(schema, argc, argv);
+    ASSERT_TRUE(options.valid());
+    EXPECT_EQ(options['i'].asInteger(), 7);
+
+    const sclap::Span<int> ids = options['i'].asIntegerSpan();
+    ASSERT_EQ(ids.size(), 1u + 5 + 2 + 1 + 2 + 1000000);
+    const int head[] = { 7, 1, 2, 3, 4, 5, -2, -1, 3, 2147483646, 2147483647, 0 };
+    for (size_t i = 0; i < sizeof(head) / sizeof(*head); ++i)
+    {
+        EXPECT_EQ(ids[i], head[i]);
+    }
+    EXPECT_EQ(ids[ids.size() - 1], 999999);
+    EXPECT_EQ(options['i'].asRealSpan().size(), ids.size());
+
+    char* descending[] = { "Program Name", "--ids=5-1", NULL };
+    EXPECT_FALSE(sclap::Options(schema, 2, descending).valid());
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(PackedListTest, HugeRange)
+{
+    const sclap::Schema<1, kPackedOptions> schema;
+
+    // single values are answered from the recorded ranges
+    char* longest[] = { "Program Name", "--ids=3-1048577,9", NULL };
+    sclap::Options options(schema, 2, longest);
+    ASSERT_TRUE(options.valid()) << options.error();
+    EXPECT_EQ(options['i'].size(), sclap::LIST_RANGE_MAX);
+    EXPECT_EQ(options['i'].asInteger(), 3);
+    EXPECT_EQ(options['i'].asString(), "3");
+    EXPECT_TRUE(options['i'].asBool());
+    EXPECT_EQ(options['i'].asIntegerSpan().size(), sclap::LIST_RANGE_MAX);
+
+    char* huge[] = { "Program Name", "--ids=0-2147483647,1", NULL };
+    sclap::Options hugeOptions(schema, 2, huge);
+    EXPECT_FALSE(hugeOptions.valid());
+    ASSERT_EQ(hugeOptions.errors().size(), 1u);
+    EXPECT_EQ(hugeOptions.errors()[0].code, sclap::ERROR_READ_ARGUMENT);
+    EXPECT_EQ(hugeOptions.errors()[0].argumentIndex, 1);
+
+    // the limit holds for all ranges of a list together
+    char* together[] = { "Program Name", "--ids=1-600000,1-600000", NULL };
+    EXPECT_FALSE(sclap::Options(schema, 2, together).valid());
+
+    sclap::Options lazy(schema, 2, huge, NULL, sclap::PARSE_LAZY);
+    EXPECT_FALSE(lazy['i'].valid());
+    EXPECT_EQ(lazy['i'].size(), 0u);
+
+    sclap::OptionVisitor ignore;
+    EXPECT_FALSE(sclap::visitOptions(schema, 2, huge, ignore));
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(PackedListTest, Visitor)
+{
+    char* argv[] = { "Program Name", "--ids=1-3,9", "--names=x,y", NULL };
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('i', "ids", sclap::ARG_INT_VEC, ',')
+                << sclap::OptionDescriptor('n', "names", sclap::ARG_STRING_VEC, ',');
+
+    struct Collector : sclap::OptionVisitor
+    {
+        std::vector<int> ints;
+        std::vector<std::string> strings;
+
+        bool onInteger(const sclap::DescriptorView&, int value) { ints.push_back(value); return true; }
+        bool onString(const sclap::DescriptorView&, sclap::StringView value)
+        {
+            strings.push_back(value.str());
+            return true;
+        }
+    } collector;
+
+    EXPECT_TRUE(sclap::visitOptions(descriptors, 3, argv, collector));
+    EXPECT_EQ(collector.ints, std::vector<int>({ 1, 2, 3, 9 }));
+    EXPECT_EQ(collector.strings, std::vector<std::string>({ "x", "y" }));
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+int parseCountInSecondUnit(int argc, char** argv);
+
+TEST(LibraryTest, SecondTranslationUnit)
+{
+    char* argv[] = { "Program Name", "--count", "7", NULL };
+
+    EXPECT_EQ(parseCountInSecondUnit(3, argv), 7);
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('c', "count", sclap::ARG_INT);
+
+    sclap::Options options(descriptors, 3, argv);
+    EXPECT_EQ(options["count"].asInteger(), 7);
+    EXPECT_EQ(options["missing"].type(), sclap::UNEXISTED);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(WideTypesTest, AllTypes)
+{
+    char* argv[] = { "Program Name", "--offset", "-9000000000", "--count=18446744073709551615",
+        "--cache", "64K", "--limit=3G", "--weights", "0.5", "2", "1e30", "--packed=1.5,2", NULL };
+    const int argc = 12;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('o', "offset", sclap::ARG_INT64)
+                << sclap::OptionDescriptor('c', "count", sclap::ARG_UINT64)
+                << sclap::OptionDescriptor('C', "cache", sclap::ARG_SIZE)
+                << sclap::OptionDescriptor('l', "limit", sclap::ARG_SIZE)
+                << sclap::OptionDescriptor('w', "weights", sclap::ARG_FLOAT_VEC)
+                << sclap::OptionDescriptor('p', "packed", sclap::ARG_FLOAT_VEC, ',');
+
+    const uint32_t flags[] = { sclap::PARSE_DEFAULT, sclap::PARSE_LAZY };
+    for (size_t f = 0; f < sizeof(flags) / sizeof(*flags); ++f)
+    {
+        sclap::Options options(descriptors, argc, argv, NULL, flags[f]);
+        ASSERT_TRUE(options.valid()) << options.error();
+        EXPECT_EQ(options["offset"].type(), sclap::ARG_INT64);
+        EXPECT_EQ(options["offset"].asInt64(), -9000000000LL);
+        EXPECT_EQ(options["count"].asUInt64(), 18446744073709551615ULL);
+        EXPECT_EQ(options["cache"].asUInt64(), 65536u);
+        EXPECT_EQ(options["limit"].asUInt64(), 3ULL << 30);
+        EXPECT_EQ(options["limit"].asString(), "3221225472");
+        EXPECT_EQ(options["weights"].asFloatVector(), std::vector<float>({ 0.5f, 2.0f, 1e30f }));
+        ASSERT_EQ(options["weights"].asRealSpan().size(), 3u);
+        EXPECT_EQ(options["weights"].asRealSpan()[2], (double)1e30f);
+        EXPECT_EQ(options["packed"].asFloatSpan().size(), 2u);
+        EXPECT_EQ(options["packed"].asFloatSpan()[0], 1.5f);
+    }
+
+    // plain ints are 64 bit wide too
+    char* small[] = { "Program Name", "-o", "5", NULL };
+    EXPECT_EQ(sclap::Options(descriptors, 3, small)['o'].asInt64(), 5);
+
+    const char* bad[][2] = {
+        { "--count", "-1" }, { "--count", "18446744073709551616" }, { "--offset", "9223372036854775808" },
+        { "--cache", "16T" }, { "--cache", "1KB" }, { "--cache", "17179869184G" }, { "--weights", "1e39" }
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(*bad); ++i)
+    {
+        char* args[] = { "Program Name", (char*)bad[i][0], (char*)bad[i][1], NULL };
+        EXPECT_FALSE(sclap::Options(descriptors, 3, args).valid()) << bad[i][0] << " " << bad[i][1];
+    }
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(WideTypesTest, SharedValues)
+{
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('s', "", sclap::ARG_SIZE)
+                << sclap::OptionDescriptor('f', "", sclap::ARG_FLOAT_VEC)
+                << sclap::OptionDescriptor('r', "", sclap::ARG_REAL)
+                << sclap::OptionDescriptor('n', "", sclap::ARG_STRING_VEC);
+
+    // the widest type of the options of one argument is read
+    char* floatReal[] = { "Program Name", "-fr", "2.5", "1", NULL };
+    EXPECT_EQ(sclap::Options(descriptors, 4, floatReal)['f'].type(), sclap::ARG_REAL_VEC);
+
+    // vector elements would narrow a 64 bit value, the argument fails instead
+    char* sizeStrings[] = { "Program Name", "-sn", "7", "8", NULL };
+    sclap::Options options(descriptors, 4, sizeStrings);
+    EXPECT_FALSE(options.valid());
+    ASSERT_EQ(options.errors().size(), 1u);
+    EXPECT_EQ(options.errors()[0].code, sclap::ERROR_WIDE_SHARED_ARGUMENT);
+    EXPECT_EQ(options.errors()[0].argumentIndex, 1);
+    EXPECT_EQ(options.error(), "Error: -sn. A 64 bit option can not share an argument with options of this type.\n");
+
+    sclap::OptionDescriptors wide;
+    wide << sclap::OptionDescriptor('o', "offset", sclap::ARG_INT64)
+         << sclap::OptionDescriptor('t', "tags", sclap::ARG_INT_VEC)
+         << sclap::OptionDescriptor('f', "floats", sclap::ARG_FLOAT_VEC);
+    char* offsetInts[] = { "Program Name", "-ot", "5000000000", NULL };
+    EXPECT_FALSE(sclap::Options(wide, 3, offsetInts, NULL, sclap::PARSE_LAZY).valid());
+    char* offsetFloats[] = { "Program Name", "-of", "5000000000", NULL };
+    EXPECT_FALSE(sclap::Options(wide, 3, offsetFloats).valid());
+    char* offset[] = { "Program Name", "-o", "5000000000", NULL };
+    EXPECT_EQ(sclap::Options(wide, 3, offset)['o'].asInt64(), 5000000000LL);
+
+    // a double can not hold every 64 bit value, and 64K is not a number of another type
+    sclap::OptionDescriptors mixed;
+    mixed << sclap::OptionDescriptor('a', "", sclap::ARG_INT64)
+          << sclap::OptionDescriptor('b', "", sclap::ARG_REAL)
+          << sclap::OptionDescriptor('s', "", sclap::ARG_SIZE)
+          << sclap::OptionDescriptor('i', "", sclap::ARG_INT)
+          << sclap::OptionDescriptor('t', "", sclap::ARG_STRING);
+    const char* rejected[][2] = {
+        { "-ab", "9007199254740993" }, { "-sb", "64K" }, { "-sb", "2.5" }, { "-si", "64K" }, { "-sa", "64" }
+    };
+    for (size_t i = 0; i < sizeof(rejected) / sizeof(*rejected); ++i)
+    {
+        char* args[] = { "Program Name", (char*)rejected[i][0], (char*)rejected[i][1], NULL };
+        sclap::Options shared(mixed, 3, args);
+        EXPECT_FALSE(shared.valid()) << rejected[i][0] << " " << rejected[i][1];
+        ASSERT_EQ(shared.errors().size(), 1u);
+        EXPECT_EQ(shared.errors()[0].code, sclap::ERROR_WIDE_SHARED_ARGUMENT);
+    }
+    char* int64Int[] = { "Program Name", "-ai", "9007199254740993", NULL };
+    EXPECT_EQ(sclap::Options(mixed, 3, int64Int)['a'].asInt64(), 9007199254740993LL);
+    char* sizeString[] = { "Program Name", "-st", "64K", NULL };
+    EXPECT_EQ(sclap::Options(mixed, 3, sizeString)['s'].asUInt64(), 65536u);
+
+    sclap::OptionVisitor ignore;
+    sclap::Error visitError;
+    EXPECT_FALSE(sclap::visitOptions(wide, 3, offsetInts, ignore, &visitError));
+    EXPECT_EQ(visitError.code, sclap::ERROR_WIDE_SHARED_ARGUMENT);
+
+    struct Collector : sclap::OptionVisitor
+    {
+        std::vector<uint64_t> sizes;
+        std::vector<double> reals;
+
+        bool onUnsigned64(const sclap::DescriptorView&, uint64_t value) { sizes.push_back(value); return true; }
+        bool onReal(const sclap::DescriptorView&, double value) { reals.push_back(value); return true; }
+    } collector;
+
+    char* visited[] = { "Program Name", "-s", "2M", "-f", "0.1", "3", NULL };
+    EXPECT_TRUE(sclap::visitOptions(descriptors, 6, visited, collector));
+    EXPECT_EQ(collector.sizes, std::vector<uint64_t>({ 2u << 20 }));
+    EXPECT_EQ(collector.reals, std::vector<double>({ 0.1, 3 }));
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+static void setEnvironment(const char* name, const char* value)
+{
+#ifdef _WIN32
+    _putenv_s(name, value ? value : "");
+#else
+    if (value) setenv(name, value, 1);
+    else unsetenv(name);
+#endif
+}
+
+constexpr sclap::SchemaOption kEnvironmentOptions[] = {
+    sclap::SchemaOption('p', "port", sclap::ARG_INT, sclap::LIST_DELIMITER_NONE, "SCLAP_TEST_PORT"),
+    sclap::SchemaOption('v', "verbose", sclap::ARG_BOOL),
+    sclap::SchemaOption('h', "hosts", sclap::ARG_STRING_VEC, ',', "SCLAP_TEST_HOSTS")
+};
+
+TEST(EnvironmentTest, Fallback)
+{
+    setEnvironment("SCLAP_TEST_PORT", "8080");
+    setEnvironment("SCLAP_TEST_HOSTS", "a,b,c");
+    setEnvironment("SCLAP_TEST_SIZE", "2K");
+    setEnvironment("SCLAP_TEST_NAME", NULL);
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('p', "port", sclap::ARG_INT, sclap::LIST_DELIMITER_NONE, "SCLAP_TEST_PORT")
+                << sclap::OptionDescriptor('s', "size", sclap::ARG_SIZE, sclap::LIST_DELIMITER_NONE, "SCLAP_TEST_SIZE")
+                << sclap::OptionDescriptor('n', "name", sclap::ARG_STRING, sclap::LIST_DELIMITER_NONE, "SCLAP_TEST_NAME")
+                << sclap::OptionDescriptor('h', "hosts", sclap::ARG_STRING_VEC, ',', "SCLAP_TEST_HOSTS");
+    ASSERT_EQ(descriptors.environmentSize(), 4u);
+    EXPECT_STREQ(descriptors.environmentDescriptor(1).environmentName(), "SCLAP_TEST_SIZE");
+
+    // argv wins over the environment
+    char* argv[] = { "Program Name", "--port", "9090", NULL };
+    const std::shared_ptr<const sclap::CompiledDescriptors> compiled = descriptors.compile();
+    sclap::Options options(compiled, 3, argv);
+    ASSERT_TRUE(options.valid()) << options.error();
+    EXPECT_EQ(options["port"].asInteger(), 9090);
+    EXPECT_EQ(options['s'].asUInt64(), 2048u);
+    EXPECT_EQ(options["name"].type(), sclap::UNEXISTED);
+    ASSERT_EQ(options['h'].asStringViews().size(), 3u);
+    EXPECT_EQ(options["hosts"].asStringViews()[2], "c");
+
+    // read right away and copied, also with an arena, zero copy and lazy
+    sclap::Arena arena(1 << 12);
+    char* empty[] = { "Program Name", NULL };
+    sclap::Options lazy(compiled, 1, empty, &arena, sclap::PARSE_ZERO_COPY | sclap::PARSE_LAZY);
+    setEnvironment("SCLAP_TEST_HOSTS", "x");
+    ASSERT_TRUE(lazy.valid());
+    EXPECT_EQ(lazy['p'].asInteger(), 8080);
+    EXPECT_EQ(lazy["hosts"].asStringVector(), std::vector<std::string>({ "a", "b", "c" }));
+
+    // from a schema
+    const sclap::Schema<3, kEnvironmentOptions> schema;
+    EXPECT_EQ(schema.environmentSize(), 2u);
+    EXPECT_EQ(schema.environmentDescriptor(1).shortName(), 'h');
+    sclap::Options fromSchema(schema, 1, empty);
+    EXPECT_EQ(fromSchema['p'].asInteger(), 8080);
+    EXPECT_EQ(fromSchema['h'].asStringViews().size(), 1u);
+    EXPECT_EQ(fromSchema['v'].type(), sclap::UNEXISTED);
+
+    setEnvironment("SCLAP_TEST_PORT", "80x");
+    sclap::Options invalid(descriptors, 1, empty);
+    EXPECT_FALSE(invalid.valid());
+    ASSERT_EQ(invalid.errors().size(), 1u);
+    EXPECT_EQ(invalid.errors()[0].code, sclap::ERROR_ENVIRONMENT);
+    EXPECT_EQ(invalid.errors()[0].argumentIndex, -1);
+    // the value is left out, it may be a secret
+    EXPECT_EQ(invalid.errors()[0].subject, "SCLAP_TEST_PORT");
+    EXPECT_EQ(invalid.error(), "Error: SCLAP_TEST_PORT. Can not read the value of environment variable.\n");
+
+    // booleans also accept 1 and 0
+    sclap::OptionDescriptors flags;
+    flags << sclap::OptionDescriptor('d', "debug", sclap::ARG_BOOL, sclap::LIST_DELIMITER_NONE, "SCLAP_TEST_DEBUG");
+    const char* values[][2] = { { "1", "true" }, { "0", "false" }, { "true", "true" }, { "false", "false" } };
+    for (size_t i = 0; i < sizeof(values) / sizeof(*values); ++i)
+    {
+        setEnvironment("SCLAP_TEST_DEBUG", values[i][0]);
+        sclap::Options flag(flags, 1, empty);
+        ASSERT_TRUE(flag.valid()) << values[i][0];
+        EXPECT_EQ(flag["debug"].asString(), values[i][1]);
+    }
+    setEnvironment("SCLAP_TEST_DEBUG", "yes");
+    EXPECT_FALSE(sclap::Options(flags, 1, empty).valid());
+
+    setEnvironment("SCLAP_TEST_DEBUG", NULL);
+    setEnvironment("SCLAP_TEST_PORT", NULL);
+    setEnvironment("SCLAP_TEST_HOSTS", NULL);
+    setEnvironment("SCLAP_TEST_SIZE", NULL);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(ConfigFileTest, UnderArgv)
+{
+    const char* path = "sclap_config_test.conf";
+    {
+        std::ofstream file(path);
+        file << "# settings\n"
+             << "port = 8080\n"
+             << "\n"
+             << "  name=two words  \r\n"
+             << "ints = 1 2 '3'\n"
+             << "hosts = a,b\n"
+             << "verbose =\n"
+             << "port = 1\n"
+             << "size = 4K";
+    }
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('p', "port", sclap::ARG_INT)
+                << sclap::OptionDescriptor('n', "name", sclap::ARG_STRING)
+                << sclap::OptionDescriptor('i', "ints", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('h', "hosts", sclap::ARG_STRING_VEC, ',')
+                << sclap::OptionDescriptor('v', "verbose", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('s', "size", sclap::ARG_SIZE)
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL);
+
+    char* argv[] = { "Program Name", "-p", "9090", NULL };
+    {
+        sclap::Arena arena(1 << 12);
+        sclap::Options options(descriptors, 3, argv, &arena, sclap::PARSE_ZERO_COPY);
+        ASSERT_TRUE(options.readConfigFile(path)) << options.error();
+        EXPECT_TRUE(options.valid());
+        EXPECT_EQ(options['p'].asInteger(), 9090);
+        EXPECT_EQ(options["name"].asStringView(), "two words");
+        EXPECT_EQ(options['i'].asIntegerVector(), std::vector<int>({ 1, 2, 3 }));
+        EXPECT_EQ(options["hosts"].asStringVector(), std::vector<std::string>({ "a", "b" }));
+        EXPECT_TRUE(options['v'].asBool());
+        EXPECT_EQ(options["size"].asUInt64(), 4096u);
+        EXPECT_EQ(options['r'].type(), sclap::UNEXISTED);
+    }
+
+    {
+        std::ofstream file(path);
+        file << "port = 1\nreal = x\n";
+    }
+    {
+        sclap::Options options(descriptors, 1, argv);
+        EXPECT_FALSE(options.readConfigFile(path));
+        EXPECT_FALSE(options.valid());
+        ASSERT_EQ(options.errors().size(), 1u);
+        EXPECT_EQ(options.errors()[0].code, sclap::ERROR_CONFIG_LINE);
+        EXPECT_EQ(options.errors()[0].argumentIndex, 2);
+        EXPECT_EQ(options.errors()[0].offset, 7u);
+        EXPECT_EQ(options.error(), "Error: real. Invalid config file line 2.\n");
+        EXPECT_EQ(options['p'].asInteger(), 1);
+    }
+
+    {
+        std::ofstream file(path);
+        file << "port 1\n";
+    }
+    {
+        sclap::Options options(descriptors, 1, argv);
+        EXPECT_FALSE(options.readConfigFile(path));
+        EXPECT_EQ(options.error(), "Error: port 1. Invalid config file line 1.\n");
+    }
+    std::remove(path);
+
+    sclap::Options missing(descriptors, 1, argv);
+    EXPECT_FALSE(missing.readConfigFile(path));
+    ASSERT_EQ(missing.errors().size(), 1u);
+    EXPECT_EQ(missing.errors()[0].code, sclap::ERROR_CONFIG_FILE);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(SerializeTest, RoundTrip)
+{
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('p', "port", sclap::ARG_INT)
+                << sclap::OptionDescriptor('n', "name", sclap::ARG_STRING)
+                << sclap::OptionDescriptor('i', "ints", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('h', "hosts", sclap::ARG_STRING_VEC, ',')
+                << sclap::OptionDescriptor('v', "verbose", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('x', "extra", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('s', "size", sclap::ARG_SIZE)
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL)
+                << sclap::OptionDescriptor('f', "floats", sclap::ARG_FLOAT_VEC)
+                << sclap::OptionDescriptor('l', "long", sclap::ARG_INT64);
+
+    char* argv[] = { "Program Name", "-p", "8080", "--name", "two words", "-i", "1", "2", "-vx",
+                     "--hosts=a,b", "-s", "4K", "-r", "0.5", "-f", "1.5", "2.5", "-l", "-5000000000",
+                     "-p", "1", NULL };
+    sclap::Options options(descriptors, 21, argv);
+    ASSERT_TRUE(options.valid()) << options.error();
+
+    const std::vector<char> data = options.serialize();
+    std::vector<uint64_t> aligned((data.size() + 7) / 8);
+    memcpy(aligned.data(), data.data(), data.size());
+
+    sclap::OptionsView view;
+    ASSERT_TRUE(view.open(aligned.data(), data.size()));
+    EXPECT_EQ(view.size(), 11u);
+    EXPECT_EQ(view['p'].asInteger(), 8080);
+    EXPECT_EQ(view["port"].asString(), "8080");
+    EXPECT_EQ(view["name"].asStringView(), "two words");
+    EXPECT_EQ(view['n'].asString(), "two words");
+    EXPECT_EQ(view['i'].asIntegerVector(), std::vector<int>({ 1, 2 }));
+    EXPECT_EQ(view['i'].asIntegerSpan().size(), 2u);
+    EXPECT_EQ(view['h'].asStringVector(), std::vector<std::string>({ "a", "b" }));
+    EXPECT_EQ(view['h'].size(), 2u);
+    EXPECT_EQ(view['h'].asStringView(1), "b");
+    EXPECT_TRUE(view['v'].asBool());
+    EXPECT_TRUE(view["extra"]);
+    EXPECT_EQ(view['s'].asUInt64(), 4096u);
+    EXPECT_DOUBLE_EQ(view["real"].asDouble(), 0.5);
+    EXPECT_EQ(view['f'].asFloatVector(), std::vector<float>({ 1.5f, 2.5f }));
+    EXPECT_EQ(view['f'].asIntegerSpan().size(), 0u);
+    EXPECT_EQ(view["long"].asInt64(), -5000000000LL);
+    EXPECT_EQ(view["long"].longName(), "long");
+    EXPECT_EQ(view["long"].shortName(), 'l');
+    EXPECT_EQ(view['z'].type(), sclap::UNEXISTED);
+    EXPECT_EQ(view["missing"].type(), sclap::UNEXISTED);
+    EXPECT_FALSE(view["missing"]);
+
+    const char* path = "sclap_serialize_test.bin";
+    ASSERT_TRUE(options.serialize(path));
+    {
+        sclap::OptionsView file;
+        ASSERT_TRUE(file.open(path));
+        EXPECT_EQ(file["port"].asInteger(), 8080);
+        EXPECT_EQ(file['h'].asStringVector(), std::vector<std::string>({ "a", "b" }));
+    }
+    std::remove(path);
+
+    sclap::OptionsView invalid;
+    EXPECT_FALSE(invalid.open(aligned.data(), 16));
+    aligned[0] = 0;
+    EXPECT_FALSE(invalid.open(aligned.data(), data.size()));
+    EXPECT_FALSE(invalid.valid());
+    EXPECT_EQ(invalid["port"].type(), sclap::UNEXISTED);
+    EXPECT_FALSE(invalid.open("sclap_missing_file.bin"));
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(SerializeTest, ConvertsLikeOptions)
+{
+    char* argv[] = { "Program Name", "-b", "-i", "-7", "-r", "1e20", "-s", "text",
+                     "-B", "true", "false", "-I", "3", "0", "-R", "0.5", "5",
+                     "-S", "x", "y", "-l", "-9000000000", "-u", "18446744073709551615",
+                     "-z", "4K", "-F", "0.25", "2", NULL };
+    int argc = 29;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('b', "bool", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('i', "int", sclap::ARG_INT)
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL)
+                << sclap::OptionDescriptor('s', "string", sclap::ARG_STRING)
+                << sclap::OptionDescriptor('B', "bools", sclap::ARG_BOOL_VEC)
+                << sclap::OptionDescriptor('I', "ints", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('R', "reals", sclap::ARG_REAL_VEC)
+                << sclap::OptionDescriptor('S', "strings", sclap::ARG_STRING_VEC)
+                << sclap::OptionDescriptor('l', "long", sclap::ARG_INT64)
+                << sclap::OptionDescriptor('u', "unsigned", sclap::ARG_UINT64)
+                << sclap::OptionDescriptor('z', "size", sclap::ARG_SIZE)
+                << sclap::OptionDescriptor('F', "floats", sclap::ARG_FLOAT_VEC);
+    const char names[] = "birsBIRSluzFx";
+
+    sclap::Options options(descriptors, argc, argv);
+    ASSERT_TRUE(options.valid()) << options.error();
+
+    const std::vector<char> data = options.serialize();
+    std::vector<uint64_t> aligned((data.size() + 7) / 8);
+    memcpy(aligned.data(), data.data(), data.size());
+    sclap::OptionsView view;
+    ASSERT_TRUE(view.open(aligned.data(), data.size()));
+
+    for (size_t i = 0; names[i]; ++i)
+    {
+        const sclap::Option& option = options[names[i]];
+        const sclap::OptionView stored = view[names[i]];
+        SCOPED_TRACE(std::string(1, names[i]));
+
+        EXPECT_EQ(stored.type(), option.type());
+        EXPECT_EQ(stored.size(), option.size());
+        EXPECT_EQ(stored.asBool(), option.asBool());
+        EXPECT_EQ(stored.asInteger(), option.asInteger());
+        EXPECT_EQ(stored.asInt64(), option.asInt64());
+        EXPECT_EQ(stored.asUInt64(), option.asUInt64());
+        EXPECT_EQ(stored.asDouble(), option.asDouble());
+        EXPECT_EQ(stored.asString(), option.asString());
+        EXPECT_EQ(stored.asBoolVector(), option.asBoolVector());
+        EXPECT_EQ(stored.asIntegerVector(), option.asIntegerVector());
+        EXPECT_EQ(stored.asRealVector(), option.asRealVector());
+        EXPECT_EQ(stored.asFloatVector(), option.asFloatVector());
+        EXPECT_EQ(stored.asStringVector(), option.asStringVector());
+    }
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(SerializeTest, LazyConversionError)
+{
+    char* argv[] = { "Program Name", "-r", "x", "-i", "1", "y", "-p", "80", NULL };
+    int argc = 8;
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL)
+                << sclap::OptionDescriptor('i', "ints", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('p', "port", sclap::ARG_INT);
+
+    sclap::Options options(descriptors, argc, argv, NULL, sclap::PARSE_LAZY);
+    ASSERT_TRUE(options.valid());
+    ASSERT_FALSE(options['r'].valid());
+    ASSERT_FALSE(options['i'].valid());
+
+    const std::vector<char> data = options.serialize();
+    std::vector<uint64_t> aligned((data.size() + 7) / 8);
+    memcpy(aligned.data(), data.data(), data.size());
+
+    sclap::OptionsView view;
+    ASSERT_TRUE(view.open(aligned.data(), data.size()));
+    const char names[] = "rip";
+    for (size_t i = 0; names[i]; ++i)
+    {
+        const sclap::Option& option = options[names[i]];
+        const sclap::OptionView stored = view[names[i]];
+        SCOPED_TRACE(std::string(1, names[i]));
+
+        EXPECT_EQ(stored.valid(), option.valid());
+        EXPECT_EQ(stored.type(), option.type());
+        EXPECT_EQ(stored.size(), option.size());
+        EXPECT_EQ(stored.asBool(), option.asBool());
+        EXPECT_EQ(stored.asDouble(), option.asDouble());
+        EXPECT_EQ(stored.asString(), option.asString());
+        EXPECT_EQ(stored.asIntegerVector(), option.asIntegerVector());
+    }
+    EXPECT_EQ(view['p'].asInteger(), 80);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+TEST(SerializeTest, CorruptImage)
+{
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('p', "port", sclap::ARG_INT)
+                << sclap::OptionDescriptor('h', "hosts", sclap::ARG_STRING_VEC, ',')
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL);
+
+    char* argv[] = { "Program Name", "-p", "8080", "--hosts=a,b", "-r", "0.5", NULL };
+    sclap::Options options(descriptors, 6, argv);
+    ASSERT_TRUE(options.valid()) << options.error();
+
+    typedef sclap::hidden::SerializedHeader Header;
+    typedef sclap::hidden::SerializedSlot Slot;
+    typedef sclap::hidden::SerializedOption Record;
+    typedef sclap::hidden::SerializedString String;
+
+    const std::vector<char> data = options.serialize();
+    const size_t words = (data.size() + 7) / 8;
+    std::vector<uint64_t> image(words);
+
+    // copies the image, changes it and opens it
+    struct Corrupt
+    {
+        const std::vector<char>& data;
+        std::vector<uint64_t>& image;
+
+        char* reset()
+        {
+            memcpy(image.data(), data.data(), data.size());
+            return (char*)image.data();
+        }
+        bool open()
+        {
+            sclap::OptionsView view;
+            return view.open(image.data(), data.size());
+        }
+    } corrupt = { data, image };
+
+    Header* header = (Header*)corrupt.reset();
+    ASSERT_TRUE(corrupt.open());
+    Slot* slots = (Slot*)(header + 1);
+    Record* records = (Record*)(slots + header->slots);
+    const uint32_t slotCount = header->slots;
+    const uint64_t size = header->size;
+
+    sclap::OptionsView truncated;
+    EXPECT_FALSE(truncated.open(image.data(), data.size() - 8));
+    header->size -= 8;
+    EXPECT_FALSE(corrupt.open());
+
+    corrupt.reset();
+    header->shortIndex['p'] = 3;
+    EXPECT_FALSE(corrupt.open());
+
+    corrupt.reset();
+    for (uint32_t i = 0; i < slotCount; ++i)
+    {
+        if (slots[i].option != sclap::hidden::NameIndex::NONE) slots[i].option = 1000;
+    }
+    EXPECT_FALSE(corrupt.open());
+
+    // find() would never reach an empty slot
+    corrupt.reset();
+    for (uint32_t i = 0; i < slotCount; ++i)
+    {
+        if (slots[i].option == sclap::hidden::NameIndex::NONE) slots[i].option = 0;
+    }
+    EXPECT_FALSE(corrupt.open());
+
+    corrupt.reset();
+    records[0].name = size;
+    EXPECT_FALSE(corrupt.open());
+
+    corrupt.reset();
+    records[0].count = 2;
+    EXPECT_FALSE(corrupt.open());
+
+    corrupt.reset();
+    records[1].count = (uint64_t)1 << 60;
+    EXPECT_FALSE(corrupt.open());
+
+    corrupt.reset();
+    records[2].type = 1 << 20;
+    EXPECT_FALSE(corrupt.open());
+
+    corrupt.reset();
+    ((String*)((char*)image.data() + records[1].elements))[1].size = size;
+    EXPECT_FALSE(corrupt.open());
+
+    // any byte overwritten either fails to open or reads within the image
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        ((unsigned char*)corrupt.reset())[i] ^= 0xff;
+
+        sclap::OptionsView view;
+        if (!view.open(image.data(), data.size())) continue;
+
+        const char* names[] = { "port", "hosts", "real", "p", "h", "r", "x" };
+        for (size_t j = 0; j < sizeof(names) / sizeof(*names); ++j)
+        {
+            const sclap::OptionView option = view[names[j]];
+            option.asStringVector();
+            option.asRealVector();
+            option.longName();
+        }
+    }
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+
+#ifdef SCLAP_STATS
+TEST(StatsTest, ParseStats)
+{
+    char* argv[] = { "Program Name", "-ab", "3", "--real", "0.5", "--ints", "1", "2", "--size=4K", NULL };
+
+    sclap::OptionDescriptors descriptors;
+    descriptors << sclap::OptionDescriptor('a', "alpha", sclap::ARG_BOOL)
+                << sclap::OptionDescriptor('b', "beta", sclap::ARG_INT)
+                << sclap::OptionDescriptor('r', "real", sclap::ARG_REAL)
+                << sclap::OptionDescriptor('i', "ints", sclap::ARG_INT_VEC)
+                << sclap::OptionDescriptor('s', "size", sclap::ARG_SIZE);
+
+    struct Hook : sclap::ParseHook
+    {
+        int calls;
+        sclap::ParseStats last;
+
+        void onParse(const sclap::ParseStats& stats) { ++calls; last = stats; }
+    } hook;
+    hook.calls = 0;
+    sclap::setParseHook(&hook);
+
+    sclap::Options options(descriptors, 9, argv);
+    sclap::setParseHook(NULL);
+    ASSERT_TRUE(options.valid());
+
+    const sclap::ParseStats& stats = options.stats();
+    EXPECT_EQ(stats.tokens, 8u);
+    EXPECT_EQ(stats.arguments, 4u);
+    EXPECT_EQ(stats.clusters, 1u);
+    EXPECT_EQ(stats.lookups, 5u);
+    EXPECT_GE(stats.probes, 3u);
+    EXPECT_EQ(stats.intConversions, 3u);
+    EXPECT_EQ(stats.realConversions, 1u);
+    EXPECT_EQ(stats.uint64Conversions, 1u);
+    EXPECT_EQ(stats.int64Conversions, 0u);
+    EXPECT_GT(stats.allocations, 0u);
+    EXPECT_GT(stats.allocatedBytes, 0u);
+    EXPECT_GT(stats.nameTime + stats.typeTime + stats.readTime, 0u);
+
+    EXPECT_EQ(hook.calls, 1);
+    EXPECT_EQ(hook.last.tokens, stats.tokens);
+
+    // everything is allocated from the arena, a single block
+    sclap::Arena arena(1 << 16);
+    sclap::Options arenaOptions(descriptors, 9, argv, &arena);
+    EXPECT_EQ(arenaOptions.stats().allocations, 1u);
+    EXPECT_EQ(hook.calls, 1);
+}
+
+/*////////////////////////////////////////////////////////////////////////////////////////////////*/
+#endif